@@ -2,5 +2,6 @@
 
 mkdir -p ../../build
 pushd ../../build
-c++ -DHANDMADE_INTERNAL=1 -DHANDMADE_SLOW=1 ../handmade/code/sdl_handmade.cpp -o HandmadeHero -g `sdl2-config --cflags --libs`
+c++ -DHANDMADE_INTERNAL=1 -DHANDMADE_SLOW=1 ../handmade/code/sdl_handmade.cpp -o HandmadeHero -g -lpthread `sdl2-config --cflags --libs`
+c++ -DHANDMADE_INTERNAL=1 -DHANDMADE_SLOW=0 -O2 ../handmade/code/handmade_bench.cpp -o HandmadeBench -g -lpthread `sdl2-config --cflags --libs`
 popd
@@ -1,4 +1,9 @@
 #include "handmade.h"
+#include "handmade_entity.cpp"
+#include "handmade_spatial.cpp"
+#include "handmade_text.cpp"
+#include "handmade_audio.cpp"
+#include "handmade_particle.cpp"
 
 internal void
 GameOutputSound(game_sound_output_buffer* SoundBuffer, int ToneHz) {
@@ -17,20 +22,88 @@ GameOutputSound(game_sound_output_buffer* SoundBuffer, int ToneHz) {
     }
 }
 
+inline void
+RenderWeirdGradientSpan(uint32* Pixel, int X, int Count, uint32 GreenBits, int BlueOffset) {
+    __m128i Blue_4x = _mm_setr_epi32(X + BlueOffset, X + BlueOffset + 1, X + BlueOffset + 2, X + BlueOffset + 3);
+    __m128i Green_4x = _mm_set1_epi32(GreenBits);
+    __m128i ByteMask_4x = _mm_set1_epi32(0xFF);
+    __m128i Four_4x = _mm_set1_epi32(4);
+
+    int Index = 0;
+    for (; Index + 4 <= Count; Index += 4) {
+        _mm_storeu_si128((__m128i*) (Pixel + Index), _mm_or_si128(_mm_and_si128(Blue_4x, ByteMask_4x), Green_4x));
+        Blue_4x = _mm_add_epi32(Blue_4x, Four_4x);
+    }
+    for (; Index < Count; ++Index) {
+        uint8 Blue = (uint8) (X + Index + BlueOffset);
+        Pixel[Index] = GreenBits | Blue;
+    }
+}
+
 internal void
 RenderWeirdGradient(game_offscreen_buffer* Buffer, int BlueOffset, int GreenOffset) {
-    uint8* Row = (uint8*) Buffer->Memory;
-    for (int Y = 0; Y < Buffer->Height; ++Y) {
-        uint32* Pixel = (uint32*) Row;
-        for (int X = 0; X < Buffer->Width; ++X) {
-            uint8 Blue = (uint8) (X + BlueOffset);
-            uint8 Green = (uint8) (Y + GreenOffset);
-
-            *Pixel++ = ((Green << 8) | Blue);
+    int Width = Buffer->Width;
+    int Height = Buffer->Height;
+    for (int Y = 0; Y < Height; ++Y) {
+        uint8 Green = (uint8) (Y + GreenOffset);
+        // NOTE: one span per row when linear, one per tile when tiled
+        for (int X = 0; X < Width;) {
+            int SpanCount = GetContiguousSpan(Buffer, X);
+            RenderWeirdGradientSpan(GetPixelPointer(Buffer, X, Y), X, SpanCount, Green << 8, BlueOffset);
+            X += SpanCount;
+        }
+    }
+}
+
+struct render_gradient_job {
+    game_offscreen_buffer Band;
+    int BlueOffset;
+    int GreenOffset;
+};
+
+internal
+PLATFORM_JOB_CALLBACK(RenderWeirdGradientJob) {
+    render_gradient_job* Job = (render_gradient_job*) Data;
+    RenderWeirdGradient(&Job->Band, Job->BlueOffset, Job->GreenOffset);
+}
+
+/*
+ * Splits the buffer into horizontal bands and renders each one as a job.
+ * Each band is a sub-buffer, so the GreenOffset is shifted by its first row.
+ * Bands start on tile boundaries when the buffer is tiled.
+ */
+internal void
+RenderWeirdGradientParallel(game_memory* Memory, memory_arena* Arena, game_offscreen_buffer* Buffer,
+                            int BlueOffset, int GreenOffset) {
+    if (!Memory->AddJob) {
+        RenderWeirdGradient(Buffer, BlueOffset, GreenOffset);
+        return;
+    }
+
+    int const BandCount = 16;
+    int TileSize = 1 << Buffer->TileShift;
+    int RowsPerBand = (Buffer->Height + BandCount - 1) / BandCount;
+    RowsPerBand = ((RowsPerBand + TileSize - 1) / TileSize) * TileSize;
+    render_gradient_job* Jobs = PushArray(Arena, BandCount, render_gradient_job);
+
+    platform_job_group Group = {};
+    for (int BandIndex = 0; BandIndex < BandCount; ++BandIndex) {
+        int MinY = BandIndex * RowsPerBand;
+        int MaxY = MinY + RowsPerBand;
+        if (MaxY > Buffer->Height) {
+            MaxY = Buffer->Height;
+        }
+        if (MinY >= MaxY) {
+            break;
         }
 
-        Row += Buffer->Pitch;
+        render_gradient_job* Job = Jobs + BandIndex;
+        Job->Band = GetBufferRows(Buffer, MinY, MaxY);
+        Job->BlueOffset = BlueOffset;
+        Job->GreenOffset = GreenOffset + MinY;
+        Memory->AddJob(Memory->JobSystem, &Group, RenderWeirdGradientJob, Job);
     }
+    Memory->WaitForJobGroup(Memory->JobSystem, &Group);
 }
 
 internal void
@@ -42,6 +115,10 @@ GameUpdateAndRender(game_memory* Memory, game_input* Input, game_offscreen_buffe
 
     game_state* GameState = (game_state*) Memory->PermanentStorage;
     if (!Memory->IsInitialized) {
+        if (!PlatformCommitMemory(Memory->PermanentStorage, sizeof(game_state))) {
+            PlatformOutOfMemory(Memory->PermanentStorage, sizeof(game_state));
+        }
+
         char* Filename = __FILE__;
 
         debug_read_file_result File = DEBUGPlatformReadEntireFile(Filename);
@@ -52,6 +129,29 @@ GameUpdateAndRender(game_memory* Memory, game_input* Input, game_offscreen_buffe
 
         GameState->ToneHz = 256;
 
+        InitializeArena(&GameState->WorldArena, Memory->PermanentStorageSize - sizeof(game_state),
+                        (uint8*) Memory->PermanentStorage + sizeof(game_state));
+        InitializeEntityStore(&GameState->Entities, &GameState->WorldArena, 65536);
+        InitializeArena(&GameState->TransientArena, Memory->TransientStorageSize, Memory->TransientStorage);
+        InitializeParticleSystem(&GameState->Particles, &GameState->TransientArena, 131072, 5678);
+        DefaultParticleTuning(&GameState->FountainTuning);
+        if (Memory->WatchFile) {
+            GameState->FountainFile = Memory->WatchFile(Memory->FileWatcher, "fountain.txt");
+        }
+
+        OpenStreamingSound(&GameState->Music, &GameState->WorldArena, "music.wav", true);
+
+        random_series Series = RandomSeed(1234);
+        for (int EntityIndex = 0; EntityIndex < 16384; ++EntityIndex) {
+            AddEntity(&GameState->Entities,
+                      RandomBetween(&Series, 0.0f, (real32) Buffer->Width),
+                      RandomBetween(&Series, 0.0f, (real32) Buffer->Height),
+                      64.0f * RandomBilateral(&Series),
+                      64.0f * RandomBilateral(&Series),
+                      EntityFlag_Moving | EntityFlag_Bounces,
+                      0xFFFFFFFF);
+        }
+
         // TODO: may be more appropriate in the platform layer
         Memory->IsInitialized = true;
     }
@@ -78,6 +178,82 @@ GameUpdateAndRender(game_memory* Memory, game_input* Input, game_offscreen_buffe
         }
     }
 
-    GameOutputSound(SoundBuffer, GameState->ToneHz);
-    RenderWeirdGradient(Buffer, GameState->BlueOffset, GameState->GreenOffset);
-}
\ No newline at end of file
+    entity_move_spec MoveSpec = {};
+    MoveSpec.MaxX = (real32) (Buffer->Width - 1);
+    MoveSpec.MaxY = (real32) (Buffer->Height - 1);
+    MoveEntities(&GameState->Entities, &MoveSpec, Input->dtForFrame);
+
+    {
+        // NOTE: tuning edits on disk show up here a frame or so after saving
+        platform_watched_file* File = GameState->FountainFile;
+        if (File && (File->Version != GameState->FountainFileVersion)) {
+            DefaultParticleTuning(&GameState->FountainTuning);
+            ParseParticleTuning(&GameState->FountainTuning, (char*) File->Contents, File->ContentsSize);
+            GameState->FountainFileVersion = File->Version;
+        }
+
+        // NOTE: a fountain in the middle of the screen, ~100k particles alive at once
+        particle_tuning* Tuning = &GameState->FountainTuning;
+        particle_emitter Fountain = Tuning->Emitter;
+        Fountain.PosX = 0.5f * (real32) Buffer->Width;
+        Fountain.PosY = 0.5f * (real32) Buffer->Height;
+        SpawnParticles(&GameState->Particles, &Fountain, Tuning->SpawnCount);
+
+        particle_sim_spec ParticleSpec = Tuning->Spec;
+        ParticleSpec.FloorY = (real32) (Buffer->Height - 2);
+        SimulateParticles(&GameState->Particles, &ParticleSpec, Input->dtForFrame);
+    }
+
+    {
+        // NOTE: broad phase; entities touching another one are drawn red
+        entity_store* Entities = &GameState->Entities;
+        temporary_memory FrameMemory = BeginTemporaryMemory(&GameState->TransientArena);
+
+        spatial_grid Grid;
+        BuildSpatialGrid(&Grid, &GameState->TransientArena, Entities->Count,
+                         Entities->PosX, Entities->PosY, 4.0f);
+
+        uint32 MaxPairs = 4 * Entities->Count;
+        spatial_pair* Pairs = PushArray(&GameState->TransientArena, MaxPairs, spatial_pair);
+        uint32 PairCount = FindSpatialGridPairs(&Grid, 2.0f, Pairs, MaxPairs);
+        if (PairCount > MaxPairs) {
+            PairCount = MaxPairs;
+        }
+
+        for (uint32 EntityIndex = 0; EntityIndex < Entities->Count; ++EntityIndex) {
+            Entities->Color[EntityIndex] = 0xFFFFFFFF;
+        }
+        for (uint32 PairIndex = 0; PairIndex < PairCount; ++PairIndex) {
+            Entities->Color[Pairs[PairIndex].A] = 0xFFFF0000;
+            Entities->Color[Pairs[PairIndex].B] = 0xFFFF0000;
+        }
+
+        EndTemporaryMemory(FrameMemory);
+    }
+
+    if (GameState->Music.IsPlaying) {
+        OutputStreamingSound(Memory, SoundBuffer, &GameState->Music, 1.0f);
+    } else {
+        GameOutputSound(SoundBuffer, GameState->ToneHz);
+    }
+
+    temporary_memory RenderMemory = BeginTemporaryMemory(&GameState->TransientArena);
+    RenderWeirdGradientParallel(Memory, &GameState->TransientArena, Buffer,
+                                GameState->BlueOffset, GameState->GreenOffset);
+    EndTemporaryMemory(RenderMemory);
+    DrawParticles(Buffer, &GameState->Particles);
+    DrawEntities(Buffer, &GameState->Entities);
+
+    if (Memory->TrimRequested) {
+        // NOTE: every temporary block has ended, so Used is the per-frame floor
+        TrimArena(&GameState->TransientArena);
+    }
+}
+
+internal void
+GameShutdown(game_memory* Memory) {
+    if (Memory->IsInitialized) {
+        game_state* GameState = (game_state*) Memory->PermanentStorage;
+        CloseStreamingSound(Memory, &GameState->Music);
+    }
+}
@@ -49,13 +49,95 @@ internal bool32 DEBUGPlatformWriteEntireFile(char* Filename, uint32 MemorySize,
 
 #endif
 
+/*
+ * Files the game reads a piece at a time (streamed audio) rather than
+ * mapping whole. Reads are positional, so a handle carries no cursor.
+ */
+struct platform_file_handle {
+    bool32 NoErrors;
+    uint64 Size;
+    void* Platform;
+};
+
+internal platform_file_handle PlatformOpenFile(char const* Filename);
+
+internal bool32 PlatformReadDataFromFile(platform_file_handle* Handle, uint64 Offset, uint64 Size, void* Dest);
+
+internal void PlatformCloseFile(platform_file_handle* Handle);
+
+/*
+ * Game storage is reserved address space that only gets backed by memory as
+ * it is committed. A region's committed part is always a prefix: committing
+ * Size bytes at Base commits everything from the start of the region through
+ * Base + Size, and decommitting releases everything from Address (rounded up
+ * to a page) to the end. Memory outside any reserved region counts as already
+ * committed. Recommitted pages come back zeroed.
+ */
+internal bool32 PlatformCommitMemory(void* Base, memory_index Size);
+
+internal void PlatformDecommitMemoryAfter(void* Address);
+
+// NOTE: for when a commit fails and there is no way to go on; doesn't return
+internal void PlatformOutOfMemory(void* Base, memory_index Size);
+
+/*
+ * TileShift 0: rows of Width pixels, Pitch bytes apart.
+ * TileShift N: square tiles of (1 << N) pixels, each stored contiguously and
+ * row by row, with the tiles themselves in row-major order. Pitch is then the
+ * byte distance between one row of tiles and the next, and memory extends out
+ * to whole tiles on the right and bottom edges.
+ * Draw code goes through GetPixelPointer and GetContiguousSpan so it works
+ * on either layout.
+ */
 struct game_offscreen_buffer {
     void* Memory;
     int Width;
     int Height;
     int Pitch;
+    int TileShift;
 };
 
+inline uint32*
+GetPixelPointer(game_offscreen_buffer* Buffer, int X, int Y) {
+    uint8* Result;
+    int Shift = Buffer->TileShift;
+    if (Shift) {
+        int Mask = (1 << Shift) - 1;
+        int TileOffset = ((X >> Shift) << (2 * Shift)) + ((Y & Mask) << Shift) + (X & Mask);
+        Result = (uint8*) Buffer->Memory + (Y >> Shift) * Buffer->Pitch + TileOffset * 4;
+    } else {
+        Result = (uint8*) Buffer->Memory + Y * Buffer->Pitch + X * 4;
+    }
+    return ((uint32*) Result);
+}
+
+// NOTE: how many pixels, starting at X, follow each other in memory on one row
+inline int
+GetContiguousSpan(game_offscreen_buffer* Buffer, int X) {
+    int Result = Buffer->Width - X;
+    if (Buffer->TileShift) {
+        int TileSize = 1 << Buffer->TileShift;
+        int TileSpan = TileSize - (X & (TileSize - 1));
+        if (TileSpan < Result) {
+            Result = TileSpan;
+        }
+    }
+    return (Result);
+}
+
+/*
+ * Rows MinY up to MaxY as a buffer of their own. MinY has to be a multiple
+ * of the tile size.
+ */
+inline game_offscreen_buffer
+GetBufferRows(game_offscreen_buffer* Buffer, int MinY, int MaxY) {
+    Assert((MinY & ((1 << Buffer->TileShift) - 1)) == 0);
+    game_offscreen_buffer Result = *Buffer;
+    Result.Memory = (uint8*) Buffer->Memory + (MinY >> Buffer->TileShift) * Buffer->Pitch;
+    Result.Height = MaxY - MinY;
+    return (Result);
+}
+
 struct game_sound_output_buffer {
     int SamplesPerSecond;
     int SampleCount;
@@ -100,7 +182,8 @@ struct game_controller_input {
 };
 
 struct game_input {
-    // TODO: insert clock values here
+    real32 dtForFrame;
+
     game_controller_input Controllers[5];
 };
 
@@ -111,26 +194,216 @@ inline game_controller_input* GetController(game_input* Input, int unsigned Cont
     return (Result);
 }
 
+/*
+ * Jobs run on the platform's worker pool. AddJob and WaitForJobGroup may only
+ * be called from the game thread or from inside a job; WaitForJobGroup runs
+ * queued jobs itself while it waits. Anything a job pushes onto its scratch
+ * arena is popped again when the job returns.
+ */
+struct memory_arena;
+struct platform_job_system;
+
+struct platform_job_group {
+    volatile uint32 PendingCount;
+};
+
+#define PLATFORM_JOB_CALLBACK(name) void name(platform_job_system* JobSystem, void* Data)
+typedef PLATFORM_JOB_CALLBACK(platform_job_callback);
+
+#define PLATFORM_ADD_JOB(name) void name(platform_job_system* JobSystem, platform_job_group* Group, \
+                                         platform_job_callback* Callback, void* Data)
+typedef PLATFORM_ADD_JOB(platform_add_job);
+
+#define PLATFORM_WAIT_FOR_JOB_GROUP(name) void name(platform_job_system* JobSystem, platform_job_group* Group)
+typedef PLATFORM_WAIT_FOR_JOB_GROUP(platform_wait_for_job_group);
+
+#define PLATFORM_GET_SCRATCH_ARENA(name) memory_arena* name(platform_job_system* JobSystem)
+typedef PLATFORM_GET_SCRATCH_ARENA(platform_get_scratch_arena);
+
+/*
+ * A whole file the platform keeps loaded. When it changes on disk it is read
+ * again in the background and the new contents replace the old ones between
+ * frames, bumping Version. Contents stays valid for the rest of the frame it
+ * was seen in; anything derived from it should be rebuilt when Version
+ * changes rather than keeping the pointer. Version is 0 until the file has
+ * been read at least once.
+ */
+struct platform_file_watcher;
+
+struct platform_watched_file {
+    uint32 Version;
+    uint32 ContentsSize;
+    void* Contents;
+};
+
+#define PLATFORM_WATCH_FILE(name) platform_watched_file* name(platform_file_watcher* FileWatcher, char const* Filename)
+typedef PLATFORM_WATCH_FILE(platform_watch_file);
+
 struct game_memory {
     bool32 IsInitialized;
     uint64 PermanentStorageSize;
     void* PermanentStorage; // REQUIRED to be cleared to zero at startup
     uint64 TransientStorageSize;
     void* TransientStorage; // REQUIRED to be cleared to zero at startup
+
+    // NOTE: may be null, in which case the game does everything on its own thread
+    platform_job_system* JobSystem;
+    platform_add_job* AddJob;
+    platform_wait_for_job_group* WaitForJobGroup;
+    platform_get_scratch_arena* GetScratchArena;
+
+    // NOTE: may be null, in which case files are never reloaded
+    platform_file_watcher* FileWatcher;
+    platform_watch_file* WatchFile;
+
+    // NOTE: set by the platform for one frame when it has been idle for a
+    // while; the game may hand unused committed memory back then
+    bool32 TrimRequested;
 };
 
 internal void
 GameUpdateAndRender(game_memory* Memory, game_input* Input, game_offscreen_buffer* Buffer,
                     game_sound_output_buffer* SoundBuffer);
 
+// NOTE: once, after the last frame and while the job system is still up
+internal void
+GameShutdown(game_memory* Memory);
+
 //
 //
 //
 
+#define ARENA_COMMIT_GRANULARITY Kilobytes(64)
+
+struct memory_arena {
+    memory_index Size;
+    uint8* Base;
+    memory_index Used;
+
+    // NOTE: how much of the arena the platform has backed, and the most that
+    // was in use since the last TrimArena
+    memory_index CommittedSize;
+    memory_index PeakUsed;
+};
+
+internal void
+InitializeArena(memory_arena* Arena, memory_index Size, void* Base) {
+    Arena->Size = Size;
+    Arena->Base = (uint8*) Base;
+    Arena->Used = 0;
+    Arena->CommittedSize = 0;
+    Arena->PeakUsed = 0;
+}
+
+inline memory_index
+GetAlignmentOffset(memory_arena* Arena, memory_index Alignment) {
+    Assert(((Alignment - 1) & Alignment) == 0);
+
+    memory_index ResultPointer = (memory_index) Arena->Base + Arena->Used;
+    memory_index AlignmentMask = Alignment - 1;
+    memory_index AlignmentOffset = 0;
+    if (ResultPointer & AlignmentMask) {
+        AlignmentOffset = Alignment - (ResultPointer & AlignmentMask);
+    }
+
+    return (AlignmentOffset);
+}
+
+#define PushStruct(Arena, type) (type*) PushSize_(Arena, sizeof(type))
+#define PushArray(Arena, Count, type) (type*) PushSize_(Arena, (Count) * sizeof(type))
+#define PushAlignedArray(Arena, Count, type, Alignment) (type*) PushSize_(Arena, (Count) * sizeof(type), Alignment)
+
+inline memory_index
+RoundUpToCommitGranularity(memory_arena* Arena, memory_index Size) {
+    memory_index Result = (Size + ARENA_COMMIT_GRANULARITY - 1) & ~(memory_index) (ARENA_COMMIT_GRANULARITY - 1);
+    if (Result > Arena->Size) {
+        Result = Arena->Size;
+    }
+    return (Result);
+}
+
+inline void*
+PushSize_(memory_arena* Arena, memory_index Size, memory_index Alignment = 4) {
+    memory_index AlignmentOffset = GetAlignmentOffset(Arena, Alignment);
+    memory_index NewUsed = Arena->Used + AlignmentOffset + Size;
+    Assert(NewUsed <= Arena->Size);
+
+    if (NewUsed > Arena->CommittedSize) {
+        memory_index CommitSize = RoundUpToCommitGranularity(Arena, NewUsed);
+        // NOTE: handing out PROT_NONE memory would only fault later somewhere unrelated
+        if (!PlatformCommitMemory(Arena->Base, CommitSize)) {
+            PlatformOutOfMemory(Arena->Base, CommitSize);
+        }
+        Arena->CommittedSize = CommitSize;
+    }
+
+    void* Result = Arena->Base + Arena->Used + AlignmentOffset;
+    Arena->Used = NewUsed;
+
+    return (Result);
+}
+
+struct temporary_memory {
+    memory_arena* Arena;
+    memory_index Used;
+};
+
+inline temporary_memory
+BeginTemporaryMemory(memory_arena* Arena) {
+    temporary_memory Result;
+    Result.Arena = Arena;
+    Result.Used = Arena->Used;
+    return (Result);
+}
+
+inline void
+EndTemporaryMemory(temporary_memory TempMem) {
+    memory_arena* Arena = TempMem.Arena;
+    Assert(Arena->Used >= TempMem.Used);
+    if (Arena->Used > Arena->PeakUsed) {
+        Arena->PeakUsed = Arena->Used;
+    }
+    Arena->Used = TempMem.Used;
+}
+
+/*
+ * Decommits whatever the arena hasn't needed since the last trim. Only valid
+ * for an arena that ends its platform memory region.
+ */
+inline void
+TrimArena(memory_arena* Arena) {
+    memory_index KeepSize = (Arena->PeakUsed > Arena->Used) ? Arena->PeakUsed : Arena->Used;
+    KeepSize = RoundUpToCommitGranularity(Arena, KeepSize);
+    if (KeepSize < Arena->CommittedSize) {
+        PlatformDecommitMemoryAfter(Arena->Base + KeepSize);
+        Arena->CommittedSize = KeepSize;
+    }
+    Arena->PeakUsed = Arena->Used;
+}
+
+#include "handmade_random.h"
+#include "handmade_entity.h"
+#include "handmade_spatial.h"
+#include "handmade_text.h"
+#include "handmade_audio.h"
+#include "handmade_particle.h"
+
 struct game_state {
     int ToneHz;
     int GreenOffset;
     int BlueOffset;
+
+    memory_arena WorldArena;
+    entity_store Entities;
+    particle_system Particles;
+    particle_tuning FountainTuning;
+    platform_watched_file* FountainFile;
+    uint32 FountainFileVersion;
+    streaming_sound Music;
+
+    // NOTE: the particle pools sit at the bottom; everything above them is
+    // rebuilt from scratch every frame
+    memory_arena TransientArena;
 };
 
 
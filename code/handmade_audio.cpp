@@ -0,0 +1,350 @@
+
+#pragma pack(push, 1)
+struct wave_header {
+    uint32 RiffID;
+    uint32 Size;
+    uint32 WaveID;
+};
+
+struct wave_chunk {
+    uint32 ID;
+    uint32 Size;
+};
+
+struct wave_fmt {
+    uint16 wFormatTag;
+    uint16 nChannels;
+    uint32 nSamplesPerSec;
+    uint32 nAvgBytesPerSec;
+    uint16 nBlockAlign;
+    uint16 wBitsPerSample;
+};
+#pragma pack(pop)
+
+#define RIFF_CODE(a, b, c, d) (((uint32) (a) << 0) | ((uint32) (b) << 8) | ((uint32) (c) << 16) | ((uint32) (d) << 24))
+
+enum {
+    WAVE_ChunkID_fmt = RIFF_CODE('f', 'm', 't', ' '),
+    WAVE_ChunkID_data = RIFF_CODE('d', 'a', 't', 'a'),
+    WAVE_ChunkID_RIFF = RIFF_CODE('R', 'I', 'F', 'F'),
+    WAVE_ChunkID_WAVE = RIFF_CODE('W', 'A', 'V', 'E'),
+};
+
+/*
+ * Converts interleaved int16 frames into the planar float window.
+ */
+internal void
+DecodeStreamingFrames(streaming_sound* Sound, uint32 WindowFrame, uint32 FrameCount) {
+    int16* Source = Sound->ChunkBuffer;
+    real32* Left = Sound->Window[0] + WindowFrame;
+    real32* Right = Sound->Window[1] + WindowFrame;
+
+    uint32 FrameIndex = 0;
+    if (Sound->ChannelCount == 2) {
+        for (; FrameIndex + 4 <= FrameCount; FrameIndex += 4) {
+            // NOTE: L0 R0 L1 R1 L2 R2 L3 R3; each 32-bit lane holds one frame
+            __m128i Frames = _mm_loadu_si128((__m128i*) (Source + 2 * FrameIndex));
+            __m128i Left32 = _mm_srai_epi32(_mm_slli_epi32(Frames, 16), 16);
+            __m128i Right32 = _mm_srai_epi32(Frames, 16);
+            _mm_storeu_ps(Left + FrameIndex, _mm_cvtepi32_ps(Left32));
+            _mm_storeu_ps(Right + FrameIndex, _mm_cvtepi32_ps(Right32));
+        }
+        for (; FrameIndex < FrameCount; ++FrameIndex) {
+            Left[FrameIndex] = (real32) Source[2 * FrameIndex];
+            Right[FrameIndex] = (real32) Source[2 * FrameIndex + 1];
+        }
+    } else {
+        for (; FrameIndex + 4 <= FrameCount; FrameIndex += 4) {
+            __m128i Frames = _mm_loadl_epi64((__m128i*) (Source + FrameIndex));
+            __m128i Mono32 = _mm_srai_epi32(_mm_unpacklo_epi16(Frames, Frames), 16);
+            _mm_storeu_ps(Left + FrameIndex, _mm_cvtepi32_ps(Mono32));
+        }
+        for (; FrameIndex < FrameCount; ++FrameIndex) {
+            Left[FrameIndex] = (real32) Source[FrameIndex];
+        }
+    }
+}
+
+/*
+ * Returns false if the file couldn't be read; the rest of the half is
+ * silence then. Touches nothing but the half (plus the guard frame for half
+ * 0), ChunkBuffer and NextFileFrame, so it can run as a job.
+ */
+internal bool32
+FillStreamingSoundHalf(streaming_sound* Sound, uint32 Half) {
+    bool32 Result = true;
+    uint32 WindowFrame = Half * STREAM_CHUNK_FRAMES;
+    uint32 FramesLeft = STREAM_CHUNK_FRAMES;
+    uint32 BytesPerFrame = Sound->ChannelCount * sizeof(int16);
+
+    while (FramesLeft) {
+        if (Sound->NextFileFrame >= Sound->FrameCount) {
+            if (!Sound->Looping) {
+                break;
+            }
+            Sound->NextFileFrame = 0;
+        }
+
+        uint32 FramesToRead = FramesLeft;
+        if (FramesToRead > (Sound->FrameCount - Sound->NextFileFrame)) {
+            FramesToRead = (uint32) (Sound->FrameCount - Sound->NextFileFrame);
+        }
+
+        if (!PlatformReadDataFromFile(&Sound->File,
+                                      Sound->DataOffset + Sound->NextFileFrame * BytesPerFrame,
+                                      FramesToRead * BytesPerFrame,
+                                      Sound->ChunkBuffer)) {
+            // TODO: logging
+            Result = false;
+            break;
+        }
+        DecodeStreamingFrames(Sound, WindowFrame, FramesToRead);
+
+        Sound->NextFileFrame += FramesToRead;
+        WindowFrame += FramesToRead;
+        FramesLeft -= FramesToRead;
+    }
+
+    // NOTE: past the end of a one-shot track, play silence
+    for (uint32 Channel = 0; Channel < Sound->ChannelCount; ++Channel) {
+        for (uint32 Frame = WindowFrame; Frame < WindowFrame + FramesLeft; ++Frame) {
+            Sound->Window[Channel][Frame] = 0.0f;
+        }
+    }
+
+    if (Half == 0) {
+        for (uint32 Channel = 0; Channel < Sound->ChannelCount; ++Channel) {
+            Sound->Window[Channel][STREAM_WINDOW_FRAMES] = Sound->Window[Channel][0];
+        }
+    }
+
+    return (Result);
+}
+
+internal
+PLATFORM_JOB_CALLBACK(FillStreamingSoundJob) {
+    streaming_sound* Sound = (streaming_sound*) Data;
+    Sound->RefillFailed = !FillStreamingSoundHalf(Sound, Sound->RefillHalf);
+}
+
+internal void
+FinishStreamingRefill(game_memory* Memory, streaming_sound* Sound) {
+    if (Sound->RefillPending) {
+        Memory->WaitForJobGroup(Memory->JobSystem, &Sound->RefillGroup);
+        Sound->RefillPending = false;
+        if (Sound->RefillFailed) {
+            Sound->IsPlaying = false;
+        }
+    }
+}
+
+// NOTE: without a job system (Memory or AddJob null) the half is filled right here
+internal void
+StartStreamingRefill(game_memory* Memory, streaming_sound* Sound, uint32 Half) {
+    Assert(!Sound->RefillPending);
+    Sound->RefillHalf = Half;
+    if (Memory && Memory->AddJob) {
+        Sound->RefillFailed = false;
+        Sound->RefillPending = true;
+        Memory->AddJob(Memory->JobSystem, &Sound->RefillGroup, FillStreamingSoundJob, Sound);
+    } else if (!FillStreamingSoundHalf(Sound, Half)) {
+        Sound->IsPlaying = false;
+    }
+}
+
+/*
+ * Only the header is read here; the buffers are pushed even if the file
+ * can't be played, so the arena layout doesn't depend on what's on disk.
+ */
+internal bool32
+OpenStreamingSound(streaming_sound* Sound, memory_arena* Arena, char const* Filename, bool32 Looping) {
+    *Sound = {};
+    Sound->Window[0] = PushAlignedArray(Arena, STREAM_WINDOW_FRAMES + 1, real32, 16);
+    Sound->Window[1] = PushAlignedArray(Arena, STREAM_WINDOW_FRAMES + 1, real32, 16);
+    Sound->ChunkBuffer = PushAlignedArray(Arena, 2 * STREAM_CHUNK_FRAMES, int16, 16);
+    Sound->Looping = Looping;
+
+    Sound->File = PlatformOpenFile(Filename);
+    if (!Sound->File.NoErrors) {
+        return false;
+    }
+
+    wave_header Header;
+    if (!PlatformReadDataFromFile(&Sound->File, 0, sizeof(Header), &Header) ||
+        (Header.RiffID != WAVE_ChunkID_RIFF) || (Header.WaveID != WAVE_ChunkID_WAVE)) {
+        PlatformCloseFile(&Sound->File);
+        return false;
+    }
+
+    wave_fmt Format = {};
+    bool32 FoundFormat = false;
+    uint64 ChunkOffset = sizeof(Header);
+    while ((ChunkOffset + sizeof(wave_chunk)) <= Sound->File.Size) {
+        wave_chunk Chunk;
+        if (!PlatformReadDataFromFile(&Sound->File, ChunkOffset, sizeof(Chunk), &Chunk)) {
+            break;
+        }
+        uint64 ChunkDataOffset = ChunkOffset + sizeof(Chunk);
+
+        if (Chunk.ID == WAVE_ChunkID_fmt) {
+            FoundFormat = PlatformReadDataFromFile(&Sound->File, ChunkDataOffset, sizeof(Format), &Format);
+        } else if (Chunk.ID == WAVE_ChunkID_data) {
+            uint64 DataSize = Chunk.Size;
+            if (ChunkDataOffset + DataSize > Sound->File.Size) {
+                DataSize = Sound->File.Size - ChunkDataOffset;
+            }
+            Sound->DataOffset = ChunkDataOffset;
+            Sound->FrameCount = FoundFormat ? (DataSize / (Format.nChannels * sizeof(int16))) : 0;
+            break;
+        }
+
+        // NOTE: RIFF chunks are padded to an even size
+        ChunkOffset = ChunkDataOffset + ((Chunk.Size + 1) & ~1);
+    }
+
+    if (!FoundFormat || (Format.wFormatTag != 1) || (Format.wBitsPerSample != 16) ||
+        (Format.nChannels < 1) || (Format.nChannels > 2) || (Format.nSamplesPerSec == 0) ||
+        (Sound->FrameCount == 0)) {
+        // TODO: logging; only 16-bit PCM mono/stereo is supported
+        PlatformCloseFile(&Sound->File);
+        return false;
+    }
+
+    Sound->SamplesPerSecond = Format.nSamplesPerSec;
+    Sound->ChannelCount = Format.nChannels;
+
+    Sound->IsPlaying = (FillStreamingSoundHalf(Sound, 0) && FillStreamingSoundHalf(Sound, 1));
+    Sound->PlayingHalf = 0;
+
+    return (Sound->IsPlaying);
+}
+
+internal void
+CloseStreamingSound(game_memory* Memory, streaming_sound* Sound) {
+    FinishStreamingRefill(Memory, Sound);
+    PlatformCloseFile(&Sound->File);
+    Sound->IsPlaying = false;
+}
+
+/*
+ * Resamples SampleCount frames with linear interpolation, four output frames
+ * per iteration. Source positions are gathered with scalar loads (SSE2 has
+ * no gather); the interpolation, volume, saturation and L/R interleave are
+ * all done wide. The caller makes sure every source frame this reads is in
+ * the window.
+ */
+internal void
+OutputStreamingSoundPiece(streaming_sound* Sound, int16* SampleOut, int SampleCount, uint64 Step, real32 Volume) {
+    real32* Left = Sound->Window[0];
+    real32* Right = Sound->Window[(Sound->ChannelCount > 1) ? 1 : 0];
+
+    real32 StepReal = (real32) Step * (1.0f / 4294967296.0f);
+    __m128 LaneStep_4x = _mm_set_ps(3.0f * StepReal, 2.0f * StepReal, StepReal, 0.0f);
+    __m128 Volume_4x = _mm_set1_ps(Volume);
+
+    for (int SampleIndex = 0; SampleIndex < SampleCount; SampleIndex += 4) {
+        uint64 BaseFrame = Sound->Position >> 32;
+        real32 BaseFraction = (real32) (uint32) Sound->Position * (1.0f / 4294967296.0f);
+
+        __m128 LanePosition = _mm_add_ps(_mm_set1_ps(BaseFraction), LaneStep_4x);
+        __m128i LaneFrame = _mm_cvttps_epi32(LanePosition);
+        __m128 t = _mm_sub_ps(LanePosition, _mm_cvtepi32_ps(LaneFrame));
+
+        uint32 LaneOffsets[4];
+        _mm_storeu_si128((__m128i*) LaneOffsets, LaneFrame);
+
+        real32 Left0[4], Left1[4], Right0[4], Right1[4];
+        for (int Lane = 0; Lane < 4; ++Lane) {
+            uint32 Frame = (uint32) (BaseFrame + LaneOffsets[Lane]) & (STREAM_WINDOW_FRAMES - 1);
+            Left0[Lane] = Left[Frame];
+            Left1[Lane] = Left[Frame + 1];
+            Right0[Lane] = Right[Frame];
+            Right1[Lane] = Right[Frame + 1];
+        }
+
+        __m128 L0 = _mm_loadu_ps(Left0);
+        __m128 R0 = _mm_loadu_ps(Right0);
+        __m128 L = _mm_add_ps(L0, _mm_mul_ps(t, _mm_sub_ps(_mm_loadu_ps(Left1), L0)));
+        __m128 R = _mm_add_ps(R0, _mm_mul_ps(t, _mm_sub_ps(_mm_loadu_ps(Right1), R0)));
+
+        // NOTE: packs saturates, giving L0..L3 R0..R3; unpack interleaves them
+        __m128i Packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(L, Volume_4x)),
+                                         _mm_cvtps_epi32(_mm_mul_ps(R, Volume_4x)));
+        __m128i Interleaved = _mm_unpacklo_epi16(Packed, _mm_srli_si128(Packed, 8));
+
+        int FramesLeft = SampleCount - SampleIndex;
+        if (FramesLeft >= 4) {
+            _mm_storeu_si128((__m128i*) SampleOut, Interleaved);
+            SampleOut += 8;
+            Sound->Position += 4 * Step;
+        } else {
+            int16 Tail[8];
+            _mm_storeu_si128((__m128i*) Tail, Interleaved);
+            for (int TailIndex = 0; TailIndex < 2 * FramesLeft; ++TailIndex) {
+                *SampleOut++ = Tail[TailIndex];
+            }
+            Sound->Position += FramesLeft * Step;
+        }
+    }
+}
+
+/*
+ * Resamples to SoundBuffer->SamplesPerSecond, in pieces that each advance
+ * less than a chunk through the source. A frame that stalled (a slow first
+ * frame, a debugger break) can ask for most of a second of audio at once,
+ * which is more than the window holds.
+ *
+ * Crossing into a new half starts the refill of the one just left. That
+ * refill is only waited for when the output actually reaches it, a whole
+ * chunk later unless the disk is very slow.
+ */
+internal void
+OutputStreamingSound(game_memory* Memory, game_sound_output_buffer* SoundBuffer, streaming_sound* Sound,
+                     real32 Volume) {
+    int16* SampleOut = SoundBuffer->Samples;
+    int SamplesLeft = SoundBuffer->SampleCount;
+
+    if (Sound->IsPlaying) {
+        uint64 Step = ((uint64) Sound->SamplesPerSecond << 32) / (uint64) SoundBuffer->SamplesPerSecond;
+        // NOTE: a multiple of four, so splitting doesn't change what comes out
+        int MaxPieceCount = (int) ((((uint64) STREAM_CHUNK_FRAMES - 1) << 32) / Step) & ~3;
+        Assert(MaxPieceCount > 0);
+
+        while (Sound->IsPlaying && (SamplesLeft > 0)) {
+            int PieceCount = (SamplesLeft < MaxPieceCount) ? SamplesLeft : MaxPieceCount;
+
+            uint64 FirstFrame = Sound->Position >> 32;
+            uint32 CurrentHalf = (uint32) (FirstFrame / STREAM_CHUNK_FRAMES) & 1;
+            if (CurrentHalf != Sound->PlayingHalf) {
+                // NOTE: the half we just left is free, so load it with what comes after this one
+                FinishStreamingRefill(Memory, Sound);
+                Sound->PlayingHalf = CurrentHalf;
+                StartStreamingRefill(Memory, Sound, CurrentHalf ^ 1);
+            }
+
+            // NOTE: interpolation reads one frame past the last output position
+            uint64 LastFrame = ((Sound->Position + (uint64) PieceCount * Step) >> 32) + 1;
+            uint64 HalfEnd = (FirstFrame / STREAM_CHUNK_FRAMES + 1) * STREAM_CHUNK_FRAMES;
+            if (LastFrame >= HalfEnd) {
+                FinishStreamingRefill(Memory, Sound);
+            }
+            if (!Sound->IsPlaying) {
+                break;
+            }
+
+            OutputStreamingSoundPiece(Sound, SampleOut, PieceCount, Step, Volume);
+            SampleOut += 2 * PieceCount;
+            SamplesLeft -= PieceCount;
+
+            if (!Sound->Looping && ((Sound->Position >> 32) >= Sound->FrameCount)) {
+                Sound->IsPlaying = false;
+            }
+        }
+    }
+
+    // NOTE: whatever is left once the sound stops (or if it never played) is silence
+    for (int SampleIndex = 0; SampleIndex < SamplesLeft; ++SampleIndex) {
+        *SampleOut++ = 0;
+        *SampleOut++ = 0;
+    }
+}
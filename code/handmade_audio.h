@@ -0,0 +1,43 @@
+#if !defined(HANDMADE_AUDIO_H)
+
+/*
+ * A streaming_sound plays a 16-bit PCM WAV straight off disk. Decoded frames
+ * live in a per-channel ring of two chunk-sized halves: while the output
+ * cursor is in one half, the other already holds the next chunk of the file.
+ * Memory use is fixed at open time no matter how long the track is.
+ */
+
+#define STREAM_CHUNK_FRAMES 8192
+#define STREAM_WINDOW_FRAMES (2 * STREAM_CHUNK_FRAMES)
+
+struct streaming_sound {
+    platform_file_handle File;
+    bool32 IsPlaying;
+    bool32 Looping;
+
+    uint32 SamplesPerSecond;
+    uint32 ChannelCount;
+    uint64 DataOffset;
+    uint64 FrameCount;
+
+    // NOTE: STREAM_WINDOW_FRAMES + 1 each; the extra guard frame mirrors
+    // frame 0 so interpolation never has to wrap.
+    real32* Window[2];
+    int16* ChunkBuffer;
+
+    uint64 NextFileFrame;
+    uint32 PlayingHalf;
+
+    // NOTE: the idle half is refilled by a job; RefillFailed is only looked
+    // at once RefillGroup has been waited on
+    platform_job_group RefillGroup;
+    bool32 RefillPending;
+    uint32 RefillHalf;
+    bool32 RefillFailed;
+
+    // NOTE: 32.32 fixed point source frames since the start of playback
+    uint64 Position;
+};
+
+#define HANDMADE_AUDIO_H
+#endif
@@ -0,0 +1,1856 @@
+/*
+ * Headless benchmark driver. Pulls in the whole platform layer (minus its
+ * main) so the kernels under test are exactly the ones the game ships, and
+ * drives GameUpdateAndRender without a window or an audio device.
+ *
+ * Every benchmark runs BENCH_WARMUP_COUNT untimed samples, then times each
+ * sample individually with fenced rdtsc and reports the min and median cost
+ * per unit of work. Results go to stdout as CSV:
+ *
+ *     name,unit,min,median
+ *
+ * Options:
+ *     --filter TEXT            only run benchmarks whose name contains TEXT
+ *     --write-baseline FILE    save this run's results as the baseline
+ *     --baseline FILE          compare medians against FILE; exit code 1 if
+ *                              anything got slower than the threshold
+ *     --threshold PERCENT      allowed slowdown before flagging (default 10)
+ *
+ * Diagnostics (regressions, cross-check failures) go to stderr so stdout
+ * stays machine-readable. A failed cross-check makes the exit code 1 too.
+ */
+
+#define HANDMADE_BENCH 1
+#include "sdl_handmade.cpp"
+
+#include <sched.h>
+#include <stdarg.h>
+
+#define BENCH_WIDTH 960
+#define BENCH_HEIGHT 540
+#define BENCH_UPDATE_HZ 30
+
+#define BENCH_WARMUP_COUNT 3
+#define BENCH_MAX_SAMPLES 256
+#define BENCH_MAX_RESULTS 128
+
+struct bench_result {
+    char Name[64];
+    char Unit[32];
+    real64 Min;
+    real64 Median;
+};
+
+struct bench_timer {
+    uint32 WarmupCount;
+    uint32 SampleCount;
+    uint64 Start;
+    uint64 Samples[BENCH_MAX_SAMPLES];
+};
+
+struct bench_state {
+    char* Filter;
+    // NOTE: cross-checks that failed; any of them fails the run, like a regression
+    uint32 FailureCount;
+    uint32 ResultCount;
+    bench_result Results[BENCH_MAX_RESULTS];
+};
+
+global_variable bench_state GlobalBench;
+
+inline uint64
+BenchReadCycles() {
+    // NOTE: keep the timed work from drifting across the timestamp read
+    _mm_lfence();
+    uint64 Result = __rdtsc();
+    _mm_lfence();
+    return (Result);
+}
+
+// NOTE: wall clock, for things that wait on the kernel or other threads
+inline uint64
+BenchReadNanoseconds() {
+    timespec Time;
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    uint64 Result = (uint64) Time.tv_sec * 1000000000ull + (uint64) Time.tv_nsec;
+    return (Result);
+}
+
+internal bool32
+BenchShouldRun(char const* Name) {
+    bool32 Result = (!GlobalBench.Filter || strstr(Name, GlobalBench.Filter));
+    return (Result);
+}
+
+internal void
+BenchRecord(char const* Name, char const* Unit, real64 Min, real64 Median) {
+    if (GlobalBench.ResultCount < BENCH_MAX_RESULTS) {
+        bench_result* Result = &GlobalBench.Results[GlobalBench.ResultCount++];
+        snprintf(Result->Name, sizeof(Result->Name), "%s", Name);
+        snprintf(Result->Unit, sizeof(Result->Unit), "%s", Unit);
+        Result->Min = Min;
+        Result->Median = Median;
+    }
+
+    printf("%s,%s,%.03f,%.03f\n", Name, Unit, Min, Median);
+    fflush(stdout);
+}
+
+internal void
+BenchFail(char const* Format, ...) {
+    va_list Args;
+    va_start(Args, Format);
+    vfprintf(stderr, Format, Args);
+    va_end(Args);
+    ++GlobalBench.FailureCount;
+}
+
+inline void
+BenchBeginSample(bench_timer* Timer) {
+    Timer->Start = BenchReadCycles();
+}
+
+// NOTE: also used for non-cycle samples, like counter deltas
+inline void
+BenchAddSample(bench_timer* Timer, uint64 Value) {
+    if (Timer->WarmupCount < BENCH_WARMUP_COUNT) {
+        ++Timer->WarmupCount;
+    } else if (Timer->SampleCount < BENCH_MAX_SAMPLES) {
+        Timer->Samples[Timer->SampleCount++] = Value;
+    }
+}
+
+inline void
+BenchEndSample(bench_timer* Timer) {
+    uint64 Cycles = BenchReadCycles() - Timer->Start;
+    BenchAddSample(Timer, Cycles);
+}
+
+#define BenchSampleCount(SampleCount) (BENCH_WARMUP_COUNT + (SampleCount))
+
+internal int
+BenchCompareCycles(const void* A, const void* B) {
+    uint64 ValueA = *(uint64*) A;
+    uint64 ValueB = *(uint64*) B;
+    int Result = (ValueA < ValueB) ? -1 : ((ValueA > ValueB) ? 1 : 0);
+    return (Result);
+}
+
+/*
+ * WorkPerSample converts cycles per sample into cycles per Unit.
+ */
+internal void
+BenchFinish(bench_timer* Timer, char const* Name, char const* Unit, real64 WorkPerSample) {
+    Assert(Timer->SampleCount > 0);
+    qsort(Timer->Samples, Timer->SampleCount, sizeof(Timer->Samples[0]), BenchCompareCycles);
+
+    real64 Min = (real64) Timer->Samples[0] / WorkPerSample;
+    real64 Median = (real64) Timer->Samples[Timer->SampleCount / 2] / WorkPerSample;
+    BenchRecord(Name, Unit, Min, Median);
+}
+
+// NOTE: affinity from before pinning, so worker threads can be spread out again
+global_variable cpu_set_t GlobalBenchUnpinnedSet;
+global_variable platform_job_system GlobalBenchJobSystem;
+
+internal void
+BenchPinToCurrentCPU() {
+    sched_getaffinity(0, sizeof(GlobalBenchUnpinnedSet), &GlobalBenchUnpinnedSet);
+    int CPU = sched_getcpu();
+    if (CPU >= 0) {
+        cpu_set_t Set;
+        CPU_ZERO(&Set);
+        CPU_SET(CPU, &Set);
+        sched_setaffinity(0, sizeof(Set), &Set);
+    }
+}
+
+/*
+ * Threads inherit the creator's affinity, so anything that starts threads
+ * goes between these two; only the benchmark thread itself stays pinned.
+ */
+internal cpu_set_t
+BenchBeginUnpinned() {
+    cpu_set_t PinnedSet;
+    sched_getaffinity(0, sizeof(PinnedSet), &PinnedSet);
+    sched_setaffinity(0, sizeof(GlobalBenchUnpinnedSet), &GlobalBenchUnpinnedSet);
+    return (PinnedSet);
+}
+
+inline void
+BenchEndUnpinned(cpu_set_t* PinnedSet) {
+    sched_setaffinity(0, sizeof(*PinnedSet), PinnedSet);
+}
+
+internal bool32
+BenchInitJobSystem(platform_job_system* JobSystem, uint32 WorkerCount) {
+    cpu_set_t PinnedSet = BenchBeginUnpinned();
+    bool32 Result = SDLInitJobSystem(JobSystem, WorkerCount, Megabytes(1));
+    BenchEndUnpinned(&PinnedSet);
+    return (Result);
+}
+
+//
+// NOTE: engine inner loops, on fixed inputs
+//
+
+global_variable volatile real32 GlobalBenchSink;
+
+internal void
+BenchRenderWeirdGradient() {
+    if (!BenchShouldRun("render_weird_gradient")) {
+        return;
+    }
+
+    game_offscreen_buffer Buffer = {};
+    Buffer.Width = BENCH_WIDTH;
+    Buffer.Height = BENCH_HEIGHT;
+    Buffer.Pitch = BENCH_WIDTH * 4;
+    Buffer.Memory = calloc(BENCH_WIDTH * BENCH_HEIGHT, 4);
+
+    bench_timer Timer = {};
+    for (int Sample = 0; Sample < BenchSampleCount(64); ++Sample) {
+        BenchBeginSample(&Timer);
+        RenderWeirdGradient(&Buffer, 7, 13);
+        BenchEndSample(&Timer);
+    }
+    BenchFinish(&Timer, "render_weird_gradient", "cycles/pixel", (real64) (BENCH_WIDTH * BENCH_HEIGHT));
+
+    free(Buffer.Memory);
+}
+
+internal void
+BenchGameOutputSound() {
+    if (!BenchShouldRun("game_output_sound")) {
+        return;
+    }
+
+    game_sound_output_buffer SoundBuffer = {};
+    SoundBuffer.SamplesPerSecond = 48000;
+    SoundBuffer.SampleCount = 48000 / BENCH_UPDATE_HZ;
+    SoundBuffer.Samples = (int16*) calloc(48000, sizeof(int16) * 2);
+
+    bench_timer Timer = {};
+    for (int Sample = 0; Sample < BenchSampleCount(128); ++Sample) {
+        BenchBeginSample(&Timer);
+        GameOutputSound(&SoundBuffer, 256);
+        BenchEndSample(&Timer);
+    }
+    BenchFinish(&Timer, "game_output_sound", "cycles/sample", (real64) SoundBuffer.SampleCount);
+
+    free(SoundBuffer.Samples);
+}
+
+internal void
+BenchSDLFillSoundBuffer() {
+    if (!BenchShouldRun("sdl_fill_sound_buffer")) {
+        return;
+    }
+
+    sdl_sound_output SoundOutput = {};
+    SoundOutput.SamplesPerSecond = 48000;
+    SoundOutput.BytesPerSample = sizeof(int16) * 2;
+    SoundOutput.SecondaryBufferSize = SoundOutput.SamplesPerSecond * SoundOutput.BytesPerSample;
+
+    sdl_audio_ring_buffer SavedRingBuffer = AudioRingBuffer;
+    AudioRingBuffer.Size = SoundOutput.SecondaryBufferSize;
+    AudioRingBuffer.Data = calloc(AudioRingBuffer.Size, 1);
+
+    game_sound_output_buffer SoundBuffer = {};
+    SoundBuffer.SamplesPerSecond = SoundOutput.SamplesPerSecond;
+    SoundBuffer.SampleCount = SoundOutput.SamplesPerSecond / BENCH_UPDATE_HZ;
+    SoundBuffer.Samples = (int16*) calloc(SoundOutput.SamplesPerSecond, SoundOutput.BytesPerSample);
+
+    // NOTE: lock half a frame's worth before the end so both regions are written
+    int BytesToWrite = SoundBuffer.SampleCount * SoundOutput.BytesPerSample;
+    int ByteToLock = SoundOutput.SecondaryBufferSize - BytesToWrite / 2;
+
+    bench_timer Timer = {};
+    for (int Sample = 0; Sample < BenchSampleCount(128); ++Sample) {
+        BenchBeginSample(&Timer);
+        SDLFillSoundBuffer(&SoundOutput, ByteToLock, BytesToWrite, &SoundBuffer);
+        BenchEndSample(&Timer);
+    }
+    BenchFinish(&Timer, "sdl_fill_sound_buffer", "cycles/sample", (real64) SoundBuffer.SampleCount);
+
+    free(SoundBuffer.Samples);
+    free(AudioRingBuffer.Data);
+    AudioRingBuffer = SavedRingBuffer;
+}
+
+internal void
+BenchSDLAudioCallback() {
+    if (!BenchShouldRun("sdl_audio_callback")) {
+        return;
+    }
+
+    sdl_audio_ring_buffer RingBuffer = {};
+    RingBuffer.Size = 48000 * sizeof(int16) * 2;
+    RingBuffer.Data = calloc(RingBuffer.Size, 1);
+
+    // NOTE: the size SDLInitAudio asks for, 512 stereo samples
+    int Length = 512 * sizeof(int16) * 2;
+    Uint8* AudioData = (Uint8*) calloc(Length, 1);
+
+    bench_timer Timer = {};
+    for (int Sample = 0; Sample < BenchSampleCount(256); ++Sample) {
+        // NOTE: start half a callback before the end so the copy wraps
+        RingBuffer.PlayCursor = RingBuffer.Size - Length / 2;
+
+        BenchBeginSample(&Timer);
+        SDLAudioCallback(&RingBuffer, AudioData, Length);
+        BenchEndSample(&Timer);
+    }
+    BenchFinish(&Timer, "sdl_audio_callback", "cycles/sample", (real64) (Length / (sizeof(int16) * 2)));
+
+    free(AudioData);
+    free(RingBuffer.Data);
+}
+
+internal void
+BenchSDLProcessGameControllerAxisValue() {
+    if (!BenchShouldRun("sdl_process_axis_value")) {
+        return;
+    }
+
+    int ValueCount = 4096;
+    int16* Values = (int16*) calloc(ValueCount, sizeof(int16));
+    random_series Series = RandomSeed(4242);
+    for (int ValueIndex = 0; ValueIndex < ValueCount; ++ValueIndex) {
+        Values[ValueIndex] = (int16) RandomNextUInt32(&Series);
+    }
+
+    bench_timer Timer = {};
+    for (int Sample = 0; Sample < BenchSampleCount(128); ++Sample) {
+        real32 Sum = 0.0f;
+        BenchBeginSample(&Timer);
+        for (int ValueIndex = 0; ValueIndex < ValueCount; ++ValueIndex) {
+            Sum += SDLProcessGameControllerAxisValue(Values[ValueIndex], 4000);
+        }
+        BenchEndSample(&Timer);
+        GlobalBenchSink = Sum;
+    }
+    BenchFinish(&Timer, "sdl_process_axis_value", "cycles/value", (real64) ValueCount);
+
+    free(Values);
+}
+
+//
+// NOTE: job system scheduling cost
+//
+
+#define BENCH_JOBS_PER_SAMPLE 1024
+
+internal
+PLATFORM_JOB_CALLBACK(BenchEmptyJob) {
+}
+
+/*
+ * Cycles from AddJob to the group draining, per empty job, so the number is
+ * pure scheduling overhead: deque push/pop, steals, wakeups and the wait.
+ */
+internal void
+BenchJobOverhead(char const* Name, platform_job_system* JobSystem) {
+    if (!BenchShouldRun(Name) || !JobSystem->Workers) {
+        return;
+    }
+
+    bench_timer Timer = {};
+    for (int Sample = 0; Sample < BenchSampleCount(128); ++Sample) {
+        platform_job_group Group = {};
+        BenchBeginSample(&Timer);
+        for (int JobIndex = 0; JobIndex < BENCH_JOBS_PER_SAMPLE; ++JobIndex) {
+            SDLAddJob(JobSystem, &Group, BenchEmptyJob, 0);
+        }
+        SDLWaitForJobGroup(JobSystem, &Group);
+        BenchEndSample(&Timer);
+    }
+    BenchFinish(&Timer, Name, "cycles/job", (real64) BENCH_JOBS_PER_SAMPLE);
+}
+
+#define BENCH_SCRATCH_WORDS 1024
+
+struct bench_scratch_job {
+    uint32 Tag;
+    memory_arena* Arena;
+    pthread_t Thread;
+    bool32 Clobbered;
+};
+
+/*
+ * Fills a scratch block with a pattern only this job writes, then reads it
+ * back. Two workers sharing one arena would push at the same offset and
+ * overwrite each other's pattern.
+ */
+internal
+PLATFORM_JOB_CALLBACK(BenchScratchJob) {
+    bench_scratch_job* Job = (bench_scratch_job*) Data;
+    Job->Arena = SDLGetScratchArena(JobSystem);
+    Job->Thread = pthread_self();
+
+    uint32* Words = PushArray(Job->Arena, BENCH_SCRATCH_WORDS, uint32);
+    for (uint32 WordIndex = 0; WordIndex < BENCH_SCRATCH_WORDS; ++WordIndex) {
+        Words[WordIndex] = Job->Tag ^ WordIndex;
+    }
+    for (uint32 WordIndex = 0; WordIndex < BENCH_SCRATCH_WORDS; ++WordIndex) {
+        if (Words[WordIndex] != (Job->Tag ^ WordIndex)) {
+            Job->Clobbered = true;
+        }
+    }
+}
+
+/*
+ * Cycles per job that pushes and fills 4KB of scratch. Afterwards every
+ * arena a job was given must belong to exactly one thread. Runs on its own
+ * four workers so the check means something on a single core machine too.
+ */
+internal void
+BenchJobScratch() {
+    platform_job_system Workers;
+    if (!BenchShouldRun("job_scratch_arena") || !BenchInitJobSystem(&Workers, 4)) {
+        return;
+    }
+    platform_job_system* JobSystem = &Workers;
+
+    bench_scratch_job* Jobs = (bench_scratch_job*) calloc(BENCH_JOBS_PER_SAMPLE, sizeof(bench_scratch_job));
+    bool32 Clobbered = false;
+    bool32 Shared = false;
+
+    bench_timer Timer = {};
+    for (int Sample = 0; Sample < BenchSampleCount(64); ++Sample) {
+        platform_job_group Group = {};
+        BenchBeginSample(&Timer);
+        for (int JobIndex = 0; JobIndex < BENCH_JOBS_PER_SAMPLE; ++JobIndex) {
+            Jobs[JobIndex].Tag = (uint32) (Sample * BENCH_JOBS_PER_SAMPLE + JobIndex) * 2654435761u;
+            SDLAddJob(JobSystem, &Group, BenchScratchJob, Jobs + JobIndex);
+        }
+        SDLWaitForJobGroup(JobSystem, &Group);
+        BenchEndSample(&Timer);
+
+        for (int JobIndex = 0; JobIndex < BENCH_JOBS_PER_SAMPLE; ++JobIndex) {
+            bench_scratch_job* Job = Jobs + JobIndex;
+            Clobbered |= Job->Clobbered;
+
+            sdl_worker* Owner = 0;
+            for (uint32 WorkerIndex = 0; WorkerIndex < JobSystem->WorkerCount; ++WorkerIndex) {
+                if (Job->Arena == &JobSystem->Workers[WorkerIndex].Scratch) {
+                    Owner = JobSystem->Workers + WorkerIndex;
+                }
+            }
+            // NOTE: worker 0 has no pthread; it is whoever runs the bench
+            pthread_t OwnerThread = (Owner && Owner->WorkerIndex) ? Owner->Thread : pthread_self();
+            if (!Owner || !pthread_equal(OwnerThread, Job->Thread)) {
+                Shared = true;
+            }
+        }
+    }
+    BenchFinish(&Timer, "job_scratch_arena", "cycles/job", (real64) BENCH_JOBS_PER_SAMPLE);
+
+    if (Clobbered) {
+        BenchFail("job_scratch_arena: a job's scratch was overwritten while it ran\n");
+    }
+    if (Shared) {
+        BenchFail("job_scratch_arena: a job got a scratch arena that isn't its worker's\n");
+    }
+
+    free(Jobs);
+    SDLShutdownJobSystem(JobSystem);
+}
+
+internal void
+BenchJobSystem() {
+    platform_job_system SingleWorker;
+    if (BenchInitJobSystem(&SingleWorker, 1)) {
+        BenchJobOverhead("job_overhead_1_worker", &SingleWorker);
+        SDLShutdownJobSystem(&SingleWorker);
+    }
+
+    BenchJobOverhead("job_overhead_pool", &GlobalBenchJobSystem);
+    BenchJobScratch();
+
+    if (!BenchShouldRun("render_weird_gradient_jobs") || !GlobalBenchJobSystem.Workers) {
+        return;
+    }
+
+    game_memory Memory = {};
+    SDLConnectJobSystem(&Memory, &GlobalBenchJobSystem);
+
+    memory_index ArenaSize = Kilobytes(64);
+    memory_arena Arena;
+    InitializeArena(&Arena, ArenaSize, malloc(ArenaSize));
+
+    game_offscreen_buffer Buffer = {};
+    Buffer.Width = BENCH_WIDTH;
+    Buffer.Height = BENCH_HEIGHT;
+    Buffer.Pitch = BENCH_WIDTH * 4;
+    Buffer.Memory = calloc(BENCH_WIDTH * BENCH_HEIGHT, 4);
+    void* Reference = calloc(BENCH_WIDTH * BENCH_HEIGHT, 4);
+
+    bench_timer Timer = {};
+    for (int Sample = 0; Sample < BenchSampleCount(64); ++Sample) {
+        temporary_memory SampleMemory = BeginTemporaryMemory(&Arena);
+        BenchBeginSample(&Timer);
+        RenderWeirdGradientParallel(&Memory, &Arena, &Buffer, 7, 13);
+        BenchEndSample(&Timer);
+        EndTemporaryMemory(SampleMemory);
+    }
+    BenchFinish(&Timer, "render_weird_gradient_jobs", "cycles/pixel", (real64) (BENCH_WIDTH * BENCH_HEIGHT));
+
+    game_offscreen_buffer ReferenceBuffer = Buffer;
+    ReferenceBuffer.Memory = Reference;
+    RenderWeirdGradient(&ReferenceBuffer, 7, 13);
+    if (memcmp(Buffer.Memory, Reference, BENCH_WIDTH * BENCH_HEIGHT * 4) != 0) {
+        BenchFail("render_weird_gradient_jobs: output differs from the serial version\n");
+    }
+
+    free(Reference);
+    free(Buffer.Memory);
+    free(Arena.Base);
+}
+
+//
+// NOTE: reserve/commit memory regions
+//
+
+#define BENCH_COMMIT_STEPS 64
+
+/*
+ * Grows an arena over a fresh reservation one commit granule at a time,
+ * touching each granule, then trims it back to nothing: the cost of the
+ * mprotect, the first-touch faults and the MADV_DONTNEED per granule.
+ */
+internal void
+BenchArenaCommit() {
+    if (!BenchShouldRun("arena_commit_and_trim")) {
+        return;
+    }
+
+    memory_index ReserveSize = BENCH_COMMIT_STEPS * ARENA_COMMIT_GRANULARITY;
+    sdl_memory_region* Region = SDLReserveMemoryRegion("bench", 0, ReserveSize);
+    if (!Region) {
+        return;
+    }
+
+    memory_arena Arena;
+    InitializeArena(&Arena, ReserveSize, Region->Base);
+
+    bench_timer Timer = {};
+    for (int Sample = 0; Sample < BenchSampleCount(64); ++Sample) {
+        BenchBeginSample(&Timer);
+        temporary_memory SampleMemory = BeginTemporaryMemory(&Arena);
+        for (int Step = 0; Step < BENCH_COMMIT_STEPS; ++Step) {
+            uint8* Granule = (uint8*) PushSize_(&Arena, ARENA_COMMIT_GRANULARITY);
+            for (memory_index Offset = 0; Offset < ARENA_COMMIT_GRANULARITY; Offset += 4096) {
+                Granule[Offset] = 1;
+            }
+        }
+        EndTemporaryMemory(SampleMemory);
+        TrimArena(&Arena);
+        TrimArena(&Arena);
+        BenchEndSample(&Timer);
+    }
+    BenchFinish(&Timer, "arena_commit_and_trim", "cycles/64KB", (real64) BENCH_COMMIT_STEPS);
+
+    if (Region->CommittedSize != 0) {
+        BenchFail("arena_commit_and_trim: %llu bytes still committed after trimming\n",
+                  (unsigned long long) Region->CommittedSize);
+    }
+    SDLReleaseMemoryRegion(Region);
+}
+
+//
+// NOTE: frame capture
+//
+
+/*
+ * The copy is what the main loop pays per captured frame; the write is how
+ * long the writer thread takes to convert and flush that frame afterwards,
+ * which bounds how fast frames can arrive before some get dropped.
+ */
+internal void
+BenchCapture() {
+    if (!BenchShouldRun("capture_frame")) {
+        return;
+    }
+
+    sdl_offscreen_buffer Backbuffer = {};
+    Backbuffer.Width = BENCH_WIDTH;
+    Backbuffer.Height = BENCH_HEIGHT;
+    Backbuffer.BytesPerPixel = 4;
+    Backbuffer.Pitch = BENCH_WIDTH * 4;
+    Backbuffer.Memory = calloc(BENCH_WIDTH * BENCH_HEIGHT, 4);
+
+    game_sound_output_buffer SoundBuffer = {};
+    SoundBuffer.SamplesPerSecond = 48000;
+    SoundBuffer.SampleCount = 48000 / BENCH_UPDATE_HZ;
+    SoundBuffer.Samples = (int16*) calloc(SoundBuffer.SampleCount, 2 * sizeof(int16));
+
+    cpu_set_t PinnedSet = BenchBeginUnpinned();
+    sdl_capture Capture;
+    bool32 Started = SDLInitCapture(&Capture, "bench_capture", BENCH_WIDTH, BENCH_HEIGHT, BENCH_UPDATE_HZ, 48000);
+    BenchEndUnpinned(&PinnedSet);
+    if (!Started) {
+        fprintf(stderr, "capture_frame: couldn't start capture to bench_capture\n");
+        free(SoundBuffer.Samples);
+        free(Backbuffer.Memory);
+        return;
+    }
+
+    game_offscreen_buffer Buffer = SDLGetGameBuffer(&Backbuffer);
+
+    bench_timer CopyTimer = {};
+    bench_timer WriteTimer = {};
+    for (int Sample = 0; Sample < BenchSampleCount(32); ++Sample) {
+        RenderWeirdGradient(&Buffer, Sample, 2 * Sample);
+
+        BenchBeginSample(&CopyTimer);
+        SDLCaptureFrame(&Capture, &Backbuffer, &SoundBuffer);
+        BenchEndSample(&CopyTimer);
+
+        BenchBeginSample(&WriteTimer);
+        while (__atomic_load_n(&Capture.ReadIndex, __ATOMIC_ACQUIRE) != Capture.WriteIndex) {
+            _mm_pause();
+        }
+        BenchEndSample(&WriteTimer);
+    }
+    BenchFinish(&CopyTimer, "capture_frame_copy", "cycles/frame", 1.0);
+    BenchFinish(&WriteTimer, "capture_frame_write", "cycles/frame", 1.0);
+
+    if (Capture.FramesDropped) {
+        fprintf(stderr, "capture_frame: %llu frames dropped with an idle ring\n",
+                (unsigned long long) Capture.FramesDropped);
+    }
+
+    SDLCloseCapture(&Capture);
+    unlink("bench_capture.y4m");
+    unlink("bench_capture.wav");
+    free(SoundBuffer.Samples);
+    free(Backbuffer.Memory);
+}
+
+//
+// NOTE: file hot reload
+//
+
+#define BENCH_RELOAD_FILE_SIZE Megabytes(1)
+
+/*
+ * Latency is from starting to rewrite the file to its new contents waiting
+ * for the main thread: the write, inotify delivery and the background read.
+ * The swap is what the main thread pays at the frame boundary to take them
+ * and free the old copy.
+ */
+internal void
+BenchFileWatcher() {
+    if (!BenchShouldRun("file_reload")) {
+        return;
+    }
+
+    cpu_set_t PinnedSet = BenchBeginUnpinned();
+    platform_file_watcher* FileWatcher = (platform_file_watcher*) calloc(1, sizeof(platform_file_watcher));
+    SDLInitFileWatcher(FileWatcher);
+    BenchEndUnpinned(&PinnedSet);
+    if (!FileWatcher->Enabled) {
+        SDLShutdownFileWatcher(FileWatcher);
+        free(FileWatcher);
+        return;
+    }
+
+    char Filename[] = "bench_reload.dat";
+    uint32* Data = (uint32*) calloc(BENCH_RELOAD_FILE_SIZE, 1);
+    uint32 WordCount = BENCH_RELOAD_FILE_SIZE / sizeof(uint32);
+    DEBUGPlatformWriteEntireFile(Filename, BENCH_RELOAD_FILE_SIZE, Data);
+    platform_watched_file* File = SDLWatchFile(FileWatcher, Filename);
+    sdl_watched_file* Watched = &FileWatcher->Files[0];
+
+    bench_timer LatencyTimer = {};
+    bench_timer SwapTimer = {};
+    uint32 Mismatches = 0;
+    uint32 TimedOut = 0;
+    for (int Sample = 0; Sample < BenchSampleCount(32); ++Sample) {
+        for (uint32 Word = 0; Word < WordCount; ++Word) {
+            Data[Word] = (uint32) Sample * 0x9E3779B9u + Word;
+        }
+        // NOTE: the watcher may share this CPU and finish before the write
+        // even returns, so the clock starts ahead of it; yield rather than spin
+        uint64 Start = BenchReadNanoseconds();
+        DEBUGPlatformWriteEntireFile(Filename, BENCH_RELOAD_FILE_SIZE, Data);
+        while (!__atomic_load_n(&Watched->PendingContents, __ATOMIC_ACQUIRE) &&
+               ((BenchReadNanoseconds() - Start) < 1000000000ull)) {
+            sched_yield();
+        }
+        uint64 Latency = BenchReadNanoseconds() - Start;
+        if (!__atomic_load_n(&Watched->PendingContents, __ATOMIC_ACQUIRE)) {
+            ++TimedOut;
+            continue;
+        }
+        BenchAddSample(&LatencyTimer, Latency);
+
+        uint32 Version = File->Version;
+        BenchBeginSample(&SwapTimer);
+        SDLSwapReloadedFiles(FileWatcher);
+        BenchEndSample(&SwapTimer);
+
+        if ((File->Version != Version + 1) || (File->ContentsSize != BENCH_RELOAD_FILE_SIZE) ||
+            (memcmp(File->Contents, Data, BENCH_RELOAD_FILE_SIZE) != 0)) {
+            ++Mismatches;
+        }
+    }
+
+    if (LatencyTimer.SampleCount && SwapTimer.SampleCount) {
+        BenchFinish(&LatencyTimer, "file_reload_latency", "us/reload", 1000.0);
+        BenchFinish(&SwapTimer, "file_reload_swap", "cycles/reload", 1.0);
+    }
+    if (TimedOut || Mismatches) {
+        BenchFail("file_reload: %u reloads never arrived, %u had the wrong contents\n",
+                  TimedOut, Mismatches);
+    }
+
+    SDLShutdownFileWatcher(FileWatcher);
+    free(FileWatcher);
+    free(Data);
+    unlink(Filename);
+}
+
+//
+// NOTE: linear vs tiled backbuffer
+//
+
+#define BENCH_DRAW_WIDTH 1920
+#define BENCH_DRAW_HEIGHT 1080
+#define BENCH_DRAWS_PER_SAMPLE 1024
+
+struct bench_draw_counters {
+    sdl_perf_counters* Perf;
+    uint64 Before[PerfCounter_Count];
+    bench_timer Misses;
+};
+
+inline void
+BenchBeginCounting(bench_draw_counters* Counters) {
+    if (Counters->Perf) {
+        SDLReadPerfCounters(Counters->Perf, Counters->Before);
+    }
+}
+
+inline void
+BenchEndCounting(bench_draw_counters* Counters) {
+    if (Counters->Perf) {
+        uint64 After[PerfCounter_Count];
+        SDLReadPerfCounters(Counters->Perf, After);
+        BenchAddSample(&Counters->Misses, After[PerfCounter_CacheMisses] - Counters->Before[PerfCounter_CacheMisses]);
+    }
+}
+
+internal void
+BenchDrawQuads(game_offscreen_buffer* Buffer, random_series* Series) {
+    for (int QuadIndex = 0; QuadIndex < BENCH_DRAWS_PER_SAMPLE; ++QuadIndex) {
+        int MinX = (int) RandomBetween(Series, -32.0f, (real32) Buffer->Width);
+        int MinY = (int) RandomBetween(Series, -32.0f, (real32) Buffer->Height);
+        int Width = (int) RandomBetween(Series, 8.0f, 64.0f);
+        int Height = (int) RandomBetween(Series, 8.0f, 64.0f);
+        DrawRectangle(Buffer, MinX, MinY, MinX + Width, MinY + Height, RandomNextUInt32(Series));
+    }
+}
+
+internal void
+BenchDrawGlyphs(game_offscreen_buffer* Buffer, glyph_atlas* Atlas, random_series* Series) {
+    for (int GlyphIndex = 0; GlyphIndex < BENCH_DRAWS_PER_SAMPLE; ++GlyphIndex) {
+        int X = (int) RandomBetween(Series, -8.0f, (real32) Buffer->Width);
+        int Y = (int) RandomBetween(Series, -8.0f, (real32) Buffer->Height);
+        glyph_metrics* Glyph = GetGlyph(Atlas, (char) ('A' + GlyphIndex % 26));
+        DrawGlyph(Buffer, Atlas, Glyph, X, Y, RandomNextUInt32(Series));
+    }
+}
+
+/*
+ * The same quads and glyphs drawn into a row-linear, an 8x8-tiled and a
+ * 16x16-tiled backbuffer, plus the copy each layout needs at present time.
+ * Glyph blits are the only bitmap drawing the renderer has, so they stand in
+ * for it. Cache misses come from perf_event when the machine exposes them.
+ */
+internal void
+BenchDrawLayouts() {
+    char const* LayoutNames[] = {"linear", "tile8", "tile16"};
+    int LayoutShifts[] = {0, 3, 4};
+
+    memory_index FontMemorySize = Kilobytes(256);
+    memory_arena FontArena;
+    InitializeArena(&FontArena, FontMemorySize, malloc(FontMemorySize));
+    glyph_atlas Atlas;
+    InitializeGlyphAtlas(&Atlas, &FontArena, 2);
+
+    sdl_perf_counters Perf = {};
+    SDLInitPerfCounters(&Perf);
+    bool32 HaveMisses = Perf.Enabled && (Perf.ReadSlot[PerfCounter_CacheMisses] != -1);
+    if (!HaveMisses) {
+        fprintf(stderr, "draw layouts: no cache-miss counter, timing only\n");
+    }
+
+    memory_index LinearSize = (memory_index) BENCH_DRAW_WIDTH * BENCH_DRAW_HEIGHT * 4;
+    void* LinearPixels = calloc(LinearSize, 1);
+    void* ReferencePixels = calloc(LinearSize, 1);
+    real64 PixelCount = (real64) BENCH_DRAW_WIDTH * BENCH_DRAW_HEIGHT;
+
+    for (int LayoutIndex = 0; LayoutIndex < ArrayCount(LayoutNames); ++LayoutIndex) {
+        char const* LayoutName = LayoutNames[LayoutIndex];
+        char Name[64];
+
+        sdl_offscreen_buffer Backbuffer = {};
+        Backbuffer.TileShift = LayoutShifts[LayoutIndex];
+        SDLAllocateBackbuffer(&Backbuffer, BENCH_DRAW_WIDTH, BENCH_DRAW_HEIGHT);
+        game_offscreen_buffer Buffer = SDLGetGameBuffer(&Backbuffer);
+
+        snprintf(Name, sizeof(Name), "draw_quads_%s", LayoutName);
+        if (BenchShouldRun(Name)) {
+            random_series Series = RandomSeed(1234);
+            bench_timer Timer = {};
+            bench_draw_counters Counters = {};
+            Counters.Perf = HaveMisses ? &Perf : 0;
+            for (int Sample = 0; Sample < BenchSampleCount(64); ++Sample) {
+                BenchBeginCounting(&Counters);
+                BenchBeginSample(&Timer);
+                BenchDrawQuads(&Buffer, &Series);
+                BenchEndSample(&Timer);
+                BenchEndCounting(&Counters);
+            }
+            BenchFinish(&Timer, Name, "cycles/quad", BENCH_DRAWS_PER_SAMPLE);
+            if (HaveMisses) {
+                snprintf(Name, sizeof(Name), "draw_quads_%s_cache_misses", LayoutName);
+                BenchFinish(&Counters.Misses, Name, "misses/quad", BENCH_DRAWS_PER_SAMPLE);
+            }
+        }
+
+        snprintf(Name, sizeof(Name), "draw_glyphs_%s", LayoutName);
+        if (BenchShouldRun(Name)) {
+            random_series Series = RandomSeed(5678);
+            bench_timer Timer = {};
+            bench_draw_counters Counters = {};
+            Counters.Perf = HaveMisses ? &Perf : 0;
+            for (int Sample = 0; Sample < BenchSampleCount(64); ++Sample) {
+                BenchBeginCounting(&Counters);
+                BenchBeginSample(&Timer);
+                BenchDrawGlyphs(&Buffer, &Atlas, &Series);
+                BenchEndSample(&Timer);
+                BenchEndCounting(&Counters);
+            }
+            BenchFinish(&Timer, Name, "cycles/glyph", BENCH_DRAWS_PER_SAMPLE);
+            if (HaveMisses) {
+                snprintf(Name, sizeof(Name), "draw_glyphs_%s_cache_misses", LayoutName);
+                BenchFinish(&Counters.Misses, Name, "misses/glyph", BENCH_DRAWS_PER_SAMPLE);
+            }
+        }
+
+        snprintf(Name, sizeof(Name), "present_copy_%s", LayoutName);
+        if (BenchShouldRun(Name)) {
+            bench_timer Timer = {};
+            for (int Sample = 0; Sample < BenchSampleCount(64); ++Sample) {
+                BenchBeginSample(&Timer);
+                SDLCopyBackbufferLinear(&Backbuffer, LinearPixels, BENCH_DRAW_WIDTH * 4);
+                BenchEndSample(&Timer);
+            }
+            BenchFinish(&Timer, Name, "cycles/pixel", PixelCount);
+        }
+
+        // NOTE: one fixed scene per layout; once de-tiled they all have to match
+        {
+            random_series Series = RandomSeed(42);
+            RenderWeirdGradient(&Buffer, 3, 5);
+            BenchDrawQuads(&Buffer, &Series);
+            BenchDrawGlyphs(&Buffer, &Atlas, &Series);
+            SDLCopyBackbufferLinear(&Backbuffer, LinearPixels, BENCH_DRAW_WIDTH * 4);
+            if (LayoutIndex == 0) {
+                memcpy(ReferencePixels, LinearPixels, LinearSize);
+            } else if (memcmp(ReferencePixels, LinearPixels, LinearSize) != 0) {
+                BenchFail("draw layouts: %s output differs from linear\n", LayoutName);
+            }
+        }
+
+        munmap(Backbuffer.Memory, Backbuffer.MemorySize);
+    }
+
+    if (Perf.Enabled) {
+        SDLClosePerfCounters(&Perf);
+    }
+    free(ReferencePixels);
+    free(LinearPixels);
+    free(FontArena.Base);
+}
+
+//
+// NOTE: whole frames through GameUpdateAndRender
+//
+
+struct bench_headless_game {
+    game_memory Memory;
+    game_input Input;
+    game_offscreen_buffer Buffer;
+    game_sound_output_buffer SoundBuffer;
+    sdl_memory_region* PermanentRegion;
+    sdl_memory_region* TransientRegion;
+};
+
+internal void
+BenchInitHeadlessGame(bench_headless_game* Game) {
+    *Game = {};
+
+    Game->Memory.PermanentStorageSize = Megabytes(64);
+    Game->Memory.TransientStorageSize = Gigabytes(1);
+    Game->PermanentRegion = SDLReserveMemoryRegion("permanent", 0, Game->Memory.PermanentStorageSize);
+    Game->TransientRegion = SDLReserveMemoryRegion("transient", 0, Game->Memory.TransientStorageSize);
+    Assert(Game->PermanentRegion && Game->TransientRegion);
+    Game->Memory.PermanentStorage = Game->PermanentRegion->Base;
+    Game->Memory.TransientStorage = Game->TransientRegion->Base;
+
+    if (GlobalBenchJobSystem.Workers) {
+        SDLConnectJobSystem(&Game->Memory, &GlobalBenchJobSystem);
+    }
+
+    Game->Input.dtForFrame = 1.0f / (real32) BENCH_UPDATE_HZ;
+
+    Game->Buffer.Width = BENCH_WIDTH;
+    Game->Buffer.Height = BENCH_HEIGHT;
+    Game->Buffer.Pitch = BENCH_WIDTH * 4;
+    Game->Buffer.Memory = calloc(BENCH_WIDTH * BENCH_HEIGHT, 4);
+
+    Game->SoundBuffer.SamplesPerSecond = 48000;
+    Game->SoundBuffer.SampleCount = 48000 / BENCH_UPDATE_HZ;
+    Game->SoundBuffer.Samples = (int16*) calloc(48000, sizeof(int16) * 2);
+}
+
+internal void
+BenchFreeHeadlessGame(bench_headless_game* Game) {
+    GameShutdown(&Game->Memory);
+    SDLReleaseMemoryRegion(Game->PermanentRegion);
+    SDLReleaseMemoryRegion(Game->TransientRegion);
+    free(Game->Buffer.Memory);
+    free(Game->SoundBuffer.Samples);
+    *Game = {};
+}
+
+internal void
+BenchHeadlessFrames(int FrameCount) {
+    if (!BenchShouldRun("game_update_and_render")) {
+        return;
+    }
+
+    bench_headless_game Game;
+    BenchInitHeadlessGame(&Game);
+
+    bench_timer Timer = {};
+    for (int FrameIndex = 0; FrameIndex < BenchSampleCount(FrameCount); ++FrameIndex) {
+        BenchBeginSample(&Timer);
+        GameUpdateAndRender(&Game.Memory, &Game.Input, &Game.Buffer, &Game.SoundBuffer);
+        BenchEndSample(&Timer);
+    }
+    BenchFinish(&Timer, "game_update_and_render", "cycles/frame", 1.0);
+
+    // NOTE: what the frames above actually cost in memory
+    SDLPrintMemoryRegions(stderr);
+    BenchFreeHeadlessGame(&Game);
+}
+
+/*
+ * Launch to first frame for the game's side of startup: fresh regions, the
+ * init frame and its page faults. The prefaulted variant runs the same
+ * background prefault main does, with the thread free to use another CPU.
+ */
+internal void
+BenchStartup(bool32 Prefault, int SampleCount) {
+    char const* Name = "startup_first_frame_cold";
+    if (Prefault) {
+        Name = "startup_first_frame_prefaulted";
+    }
+    if (!BenchShouldRun(Name)) {
+        return;
+    }
+
+    if (Prefault && (sysconf(_SC_NPROCESSORS_ONLN) < 2)) {
+        fprintf(stderr, "%s: only one CPU, so the prefault competes with the first frame\n", Name);
+    }
+
+    bench_timer Timer = {};
+    for (int Sample = 0; Sample < BenchSampleCount(SampleCount); ++Sample) {
+        uint64 Start = BenchReadNanoseconds();
+
+        bench_headless_game Game;
+        BenchInitHeadlessGame(&Game);
+
+        sdl_startup_timing Timing = {};
+        sdl_prefault PrefaultRanges = {};
+        sdl_startup_task PrefaultTask = {};
+        if (Prefault) {
+            sdl_memory_region* Regions[] = {Game.PermanentRegion, Game.TransientRegion};
+            memory_index Sizes[] = {Megabytes(4), Megabytes(8)};
+            for (int RegionIndex = 0; RegionIndex < ArrayCount(Regions); ++RegionIndex) {
+                if (PlatformCommitMemory(Regions[RegionIndex]->Base, Sizes[RegionIndex])) {
+                    sdl_prefault_range* Range = &PrefaultRanges.Ranges[PrefaultRanges.RangeCount++];
+                    Range->Base = Regions[RegionIndex]->Base;
+                    Range->Size = Sizes[RegionIndex];
+                }
+            }
+
+            cpu_set_t PinnedSet = BenchBeginUnpinned();
+            SDLStartStartupTask(&PrefaultTask, "memory prefault", SDLPrefaultTask, &PrefaultRanges);
+            BenchEndUnpinned(&PinnedSet);
+        }
+
+        GameUpdateAndRender(&Game.Memory, &Game.Input, &Game.Buffer, &Game.SoundBuffer);
+        BenchAddSample(&Timer, BenchReadNanoseconds() - Start);
+
+        SDLFinishStartupTask(&Timing, &PrefaultTask);
+        BenchFreeHeadlessGame(&Game);
+    }
+    BenchFinish(&Timer, Name, "ms", 1000000.0);
+}
+
+/*
+ * Whole frames through the present queue into a software renderer: game
+ * update and render on this thread, upload and present either inline (one
+ * buffer) or on the present thread. Pipelined, a frame should cost about
+ * max(render, present) instead of their sum; latency is submit to presented.
+ */
+internal void
+BenchPresent(uint32 BufferCount, int FrameCount) {
+    char Prefix[32];
+    if (BufferCount > 1) {
+        snprintf(Prefix, sizeof(Prefix), "present_%u_buffers", BufferCount);
+    } else {
+        snprintf(Prefix, sizeof(Prefix), "present_inline");
+    }
+    if (!BenchShouldRun(Prefix)) {
+        return;
+    }
+    Assert(BenchSampleCount(FrameCount) <= SDL_PRESENT_LATENCY_HISTORY);
+
+    SDL_Surface* Surface = SDL_CreateRGBSurfaceWithFormat(0, BENCH_WIDTH, BENCH_HEIGHT, 32,
+                                                          SDL_PIXELFORMAT_ARGB8888);
+    sdl_present_queue Queue;
+    cpu_set_t PinnedSet = BenchBeginUnpinned();
+    bool32 Initialized = Surface && SDLInitPresentQueue(&Queue, 0, Surface, BufferCount, 0);
+    BenchEndUnpinned(&PinnedSet);
+    if (!Initialized) {
+        fprintf(stderr, "%s: couldn't create a software renderer\n", Prefix);
+        if (Surface) {
+            SDL_FreeSurface(Surface);
+        }
+        return;
+    }
+    if ((BufferCount > 1) && (sysconf(_SC_NPROCESSORS_ONLN) < 2)) {
+        fprintf(stderr, "%s: only one CPU, so presenting can't overlap rendering\n", Prefix);
+    }
+
+    bench_headless_game Game;
+    BenchInitHeadlessGame(&Game);
+    void* GameBufferMemory = Game.Buffer.Memory;
+
+    bench_timer FrameTimer = {};
+    bench_timer RenderTimer = {};
+    for (int FrameIndex = 0; FrameIndex < BenchSampleCount(FrameCount); ++FrameIndex) {
+        uint64 Start = BenchReadNanoseconds();
+        sdl_offscreen_buffer* Backbuffer = SDLAcquireBackbuffer(&Queue);
+        Game.Buffer = SDLGetGameBuffer(Backbuffer);
+
+        uint64 RenderStart = BenchReadNanoseconds();
+        GameUpdateAndRender(&Game.Memory, &Game.Input, &Game.Buffer, &Game.SoundBuffer);
+        BenchAddSample(&RenderTimer, BenchReadNanoseconds() - RenderStart);
+
+        SDLSubmitBackbuffer(&Queue);
+        BenchAddSample(&FrameTimer, BenchReadNanoseconds() - Start);
+    }
+    SDLFlushPresentQueue(&Queue);
+
+    bench_timer LatencyTimer = {};
+    real64 NanosecondsPerCount = 1000000000.0 / (real64) SDL_GetPerformanceFrequency();
+    for (uint32 PresentIndex = 0; PresentIndex < Queue.PresentCount; ++PresentIndex) {
+        BenchAddSample(&LatencyTimer, (uint64) ((real64) Queue.Latencies[PresentIndex] * NanosecondsPerCount));
+    }
+    real64 PresentMS = (real64) Queue.PresentTotal * NanosecondsPerCount / (1000000.0 * (real64) Queue.PresentCount);
+
+    char Name[64];
+    snprintf(Name, sizeof(Name), "%s_frame", Prefix);
+    BenchFinish(&FrameTimer, Name, "ms/frame", 1000000.0);
+    snprintf(Name, sizeof(Name), "%s_latency", Prefix);
+    BenchFinish(&LatencyTimer, Name, "ms", 1000000.0);
+
+    // NOTE: BenchFinish sorted the frame samples; the render ones still need it
+    qsort(RenderTimer.Samples, RenderTimer.SampleCount, sizeof(RenderTimer.Samples[0]), BenchCompareCycles);
+    real64 RenderMS = (real64) RenderTimer.Samples[RenderTimer.SampleCount / 2] / 1000000.0;
+    real64 FrameMS = (real64) FrameTimer.Samples[FrameTimer.SampleCount / 2] / 1000000.0;
+    fprintf(stderr, "%s: render %.03fms, present %.03fms, frame %.03fms\n",
+            Prefix, RenderMS, PresentMS, FrameMS);
+
+    Game.Buffer.Memory = GameBufferMemory;
+    BenchFreeHeadlessGame(&Game);
+    SDLShutdownPresentQueue(&Queue);
+    SDL_FreeSurface(Surface);
+}
+
+//
+// NOTE: array-of-structs reference layout for the entity store comparison
+//
+
+struct bench_aos_entity {
+    real32 PosX;
+    real32 PosY;
+    real32 VelX;
+    real32 VelY;
+    uint32 Flags;
+    uint32 Color;
+    uint32 Slot;
+    uint32 Generation;
+};
+
+internal void
+BenchMoveEntitiesAoS(bench_aos_entity* Entities, uint32 Count, entity_move_spec* Spec, real32 dt) {
+    for (uint32 Index = 0; Index < Count; ++Index) {
+        bench_aos_entity* Entity = Entities + Index;
+        if (!(Entity->Flags & EntityFlag_Moving)) {
+            continue;
+        }
+
+        real32 ddPX = Spec->ddPX - Spec->Drag * Entity->VelX;
+        real32 ddPY = Spec->ddPY - Spec->Drag * Entity->VelY;
+        real32 NewPosX = Entity->PosX + 0.5f * dt * dt * ddPX + dt * Entity->VelX;
+        real32 NewPosY = Entity->PosY + 0.5f * dt * dt * ddPY + dt * Entity->VelY;
+        real32 NewVelX = Entity->VelX + dt * ddPX;
+        real32 NewVelY = Entity->VelY + dt * ddPY;
+
+        if (Entity->Flags & EntityFlag_Bounces) {
+            if ((NewPosX < Spec->MinX) || (NewPosX > Spec->MaxX)) {
+                NewPosX = (NewPosX < Spec->MinX) ? Spec->MinX : Spec->MaxX;
+                NewVelX = -NewVelX;
+            }
+            if ((NewPosY < Spec->MinY) || (NewPosY > Spec->MaxY)) {
+                NewPosY = (NewPosY < Spec->MinY) ? Spec->MinY : Spec->MaxY;
+                NewVelY = -NewVelY;
+            }
+        }
+
+        Entity->PosX = NewPosX;
+        Entity->PosY = NewPosY;
+        Entity->VelX = NewVelX;
+        Entity->VelY = NewVelY;
+    }
+}
+
+internal void
+BenchEntityLayouts(uint32 EntityCount, int SampleCount) {
+    char SoAName[64];
+    char AoSName[64];
+    snprintf(SoAName, sizeof(SoAName), "move_entities_soa_%u", EntityCount);
+    snprintf(AoSName, sizeof(AoSName), "move_entities_aos_%u", EntityCount);
+    if (!BenchShouldRun(SoAName) && !BenchShouldRun(AoSName)) {
+        return;
+    }
+
+    memory_index ArenaSize = Megabytes(64);
+    void* ArenaMemory = calloc(ArenaSize, 1);
+    memory_arena Arena;
+    InitializeArena(&Arena, ArenaSize, ArenaMemory);
+
+    entity_store Store;
+    InitializeEntityStore(&Store, &Arena, EntityCount);
+    bench_aos_entity* AoS = (bench_aos_entity*) calloc(EntityCount, sizeof(bench_aos_entity));
+
+    random_series Series = RandomSeed(1234);
+    for (uint32 Index = 0; Index < EntityCount; ++Index) {
+        real32 PosX = RandomBetween(&Series, 0.0f, (real32) BENCH_WIDTH);
+        real32 PosY = RandomBetween(&Series, 0.0f, (real32) BENCH_HEIGHT);
+        real32 VelX = 64.0f * RandomBilateral(&Series);
+        real32 VelY = 64.0f * RandomBilateral(&Series);
+        uint32 Flags = EntityFlag_Moving | EntityFlag_Bounces;
+
+        entity_handle Handle = AddEntity(&Store, PosX, PosY, VelX, VelY, Flags, 0xFFFFFFFF);
+        bench_aos_entity* Entity = AoS + Index;
+        Entity->PosX = PosX;
+        Entity->PosY = PosY;
+        Entity->VelX = VelX;
+        Entity->VelY = VelY;
+        Entity->Flags = Flags;
+        Entity->Color = 0xFFFFFFFF;
+        Entity->Slot = Handle.Slot;
+        Entity->Generation = Handle.Generation;
+    }
+
+    entity_move_spec Spec = {};
+    Spec.ddPY = 9.8f;
+    Spec.Drag = 0.5f;
+    Spec.MaxX = (real32) (BENCH_WIDTH - 1);
+    Spec.MaxY = (real32) (BENCH_HEIGHT - 1);
+    real32 dt = 1.0f / (real32) BENCH_UPDATE_HZ;
+
+    if (BenchShouldRun(SoAName)) {
+        bench_timer Timer = {};
+        for (int Sample = 0; Sample < BenchSampleCount(SampleCount); ++Sample) {
+            BenchBeginSample(&Timer);
+            MoveEntities(&Store, &Spec, dt);
+            BenchEndSample(&Timer);
+        }
+        BenchFinish(&Timer, SoAName, "cycles/entity", (real64) EntityCount);
+    }
+
+    if (BenchShouldRun(AoSName)) {
+        bench_timer Timer = {};
+        for (int Sample = 0; Sample < BenchSampleCount(SampleCount); ++Sample) {
+            BenchBeginSample(&Timer);
+            BenchMoveEntitiesAoS(AoS, EntityCount, &Spec, dt);
+            BenchEndSample(&Timer);
+        }
+        BenchFinish(&Timer, AoSName, "cycles/entity", (real64) EntityCount);
+    }
+
+    free(AoS);
+    free(ArenaMemory);
+}
+
+/*
+ * Checks every handle we hold against the store: live ones must find the
+ * entity they were given (Color doubles as its id), and the dense arrays must
+ * be packed with everything from Count up to the padded size cleared.
+ */
+internal bool32
+BenchCheckEntityHandles(entity_store* Store, entity_handle* Handles, uint32* Ids, uint32 HandleCount) {
+    for (uint32 HandleIndex = 0; HandleIndex < HandleCount; ++HandleIndex) {
+        entity_handle Handle = Handles[HandleIndex];
+        uint32 Index = GetEntityIndex(Store, Handle);
+        if ((Index >= Store->Count) || (Store->Color[Index] != Ids[HandleIndex]) ||
+            (Store->DenseToSlot[Index] != Handle.Slot)) {
+            return false;
+        }
+    }
+
+    if (Store->Count != HandleCount) {
+        return false;
+    }
+
+    for (uint32 Index = Store->Count; Index < EntityPaddedCount(Store->MaxCount); ++Index) {
+        if ((Store->PosX[Index] != 0.0f) || (Store->PosY[Index] != 0.0f) ||
+            (Store->VelX[Index] != 0.0f) || (Store->VelY[Index] != 0.0f) ||
+            Store->Flags[Index] || Store->Color[Index]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Removes a random half of a full store and adds as many back, timing the
+ * churn. In between, the removed handles must stop resolving (and refuse a
+ * second remove), and a re-added entity that lands in an old slot must come
+ * back with a different generation than the stale handle.
+ */
+internal void
+BenchEntityHandles(uint32 EntityCount, int SampleCount) {
+    char Name[64];
+    snprintf(Name, sizeof(Name), "entity_remove_add_%u", EntityCount);
+    if (!BenchShouldRun(Name)) {
+        return;
+    }
+
+    memory_index ArenaSize = Megabytes(16);
+    void* ArenaMemory = calloc(ArenaSize, 1);
+    memory_arena Arena;
+    InitializeArena(&Arena, ArenaSize, ArenaMemory);
+
+    entity_store Store;
+    InitializeEntityStore(&Store, &Arena, EntityCount);
+    entity_handle* Handles = PushArray(&Arena, EntityCount, entity_handle);
+    uint32* Ids = PushArray(&Arena, EntityCount, uint32);
+    entity_handle* Stale = PushArray(&Arena, EntityCount, entity_handle);
+    uint32* Order = PushArray(&Arena, EntityCount, uint32);
+
+    uint32 NextId = 1;
+    for (uint32 HandleIndex = 0; HandleIndex < EntityCount; ++HandleIndex) {
+        Ids[HandleIndex] = NextId++;
+        Handles[HandleIndex] = AddEntity(&Store, (real32) HandleIndex, 1.0f, 1.0f, 1.0f,
+                                         EntityFlag_Moving, Ids[HandleIndex]);
+        Order[HandleIndex] = HandleIndex;
+    }
+
+    random_series Series = RandomSeed(1234);
+    uint32 ChurnCount = EntityCount / 2;
+    bool32 Valid = BenchCheckEntityHandles(&Store, Handles, Ids, EntityCount);
+    bench_timer Timer = {};
+    for (int Sample = 0; Valid && (Sample < BenchSampleCount(SampleCount)); ++Sample) {
+        for (uint32 Pick = 0; Pick < ChurnCount; ++Pick) {
+            uint32 Swap = Pick + RandomNextUInt32(&Series) % (EntityCount - Pick);
+            uint32 Temp = Order[Pick];
+            Order[Pick] = Order[Swap];
+            Order[Swap] = Temp;
+        }
+
+        uint64 Start = BenchReadCycles();
+        for (uint32 Pick = 0; Pick < ChurnCount; ++Pick) {
+            uint32 HandleIndex = Order[Pick];
+            Stale[Pick] = Handles[HandleIndex];
+            RemoveEntity(&Store, Handles[HandleIndex]);
+        }
+        uint64 Cycles = BenchReadCycles() - Start;
+
+        for (uint32 Pick = 0; Valid && (Pick < ChurnCount); ++Pick) {
+            Valid = ((GetEntityIndex(&Store, Stale[Pick]) == ENTITY_INVALID_INDEX) &&
+                     !RemoveEntity(&Store, Stale[Pick]));
+        }
+        // NOTE: the survivors are whatever isn't in the first ChurnCount of Order
+        for (uint32 Pick = ChurnCount; Valid && (Pick < EntityCount); ++Pick) {
+            uint32 HandleIndex = Order[Pick];
+            uint32 Index = GetEntityIndex(&Store, Handles[HandleIndex]);
+            Valid = ((Index < Store.Count) && (Store.Color[Index] == Ids[HandleIndex]));
+        }
+
+        Start = BenchReadCycles();
+        for (uint32 Pick = 0; Pick < ChurnCount; ++Pick) {
+            uint32 HandleIndex = Order[Pick];
+            Ids[HandleIndex] = NextId++;
+            Handles[HandleIndex] = AddEntity(&Store, (real32) HandleIndex, 1.0f, 1.0f, 1.0f,
+                                             EntityFlag_Moving, Ids[HandleIndex]);
+        }
+        Cycles += BenchReadCycles() - Start;
+        BenchAddSample(&Timer, Cycles);
+
+        for (uint32 Pick = 0; Valid && (Pick < ChurnCount); ++Pick) {
+            entity_handle Handle = Handles[Order[Pick]];
+            Valid = ((Handle.Generation != 0) &&
+                     (GetEntityIndex(&Store, Stale[Pick]) == ENTITY_INVALID_INDEX));
+            for (uint32 Other = 0; Valid && (Other < ChurnCount); ++Other) {
+                Valid = ((Stale[Other].Slot != Handle.Slot) || (Stale[Other].Generation != Handle.Generation));
+            }
+        }
+        Valid = Valid && BenchCheckEntityHandles(&Store, Handles, Ids, EntityCount);
+    }
+
+    if (Valid) {
+        BenchFinish(&Timer, Name, "cycles/op", 2.0 * (real64) ChurnCount);
+    } else {
+        BenchFail("%s: handle table out of step with the dense arrays\n", Name);
+    }
+
+    free(ArenaMemory);
+}
+
+//
+// NOTE: particles
+//
+
+internal void
+BenchSpawnParticles(particle_system* System, uint32 ParticleCount) {
+    // NOTE: lives long enough that nothing retires while the bench runs, and
+    // positions spread over the whole buffer like a busy frame
+    particle_emitter Emitter = {};
+    Emitter.SpreadX = 160.0f;
+    Emitter.MinSpeedY = 200.0f;
+    Emitter.MaxSpeedY = 400.0f;
+    Emitter.MinLife = 1000.0f;
+    Emitter.MaxLife = 2000.0f;
+    Emitter.Color = 0xFF102040;
+    SpawnParticles(System, &Emitter, ParticleCount);
+
+    random_series Series = RandomSeed(1234);
+    for (uint32 Index = 0; Index < System->Count; ++Index) {
+        System->PosX[Index] = RandomBetween(&Series, 0.0f, (real32) BENCH_WIDTH);
+        System->PosY[Index] = RandomBetween(&Series, 0.0f, (real32) BENCH_HEIGHT);
+    }
+}
+
+/*
+ * The two simulation kernels side by side, the additive draw, and a whole
+ * particle frame (simulate, retire, draw) in wall-clock ms so it can be held
+ * against the 30Hz frame budget. Going over the budget fails the run, as does
+ * any difference between the kernels.
+ */
+internal void
+BenchParticles(uint32 ParticleCount, int SampleCount) {
+    char Prefix[64];
+    snprintf(Prefix, sizeof(Prefix), "particles_%u", ParticleCount);
+    if (!BenchShouldRun(Prefix)) {
+        return;
+    }
+
+    memory_index ArenaSize = Megabytes(16);
+    void* ArenaMemory = calloc(ArenaSize, 1);
+    memory_arena Arena;
+    InitializeArena(&Arena, ArenaSize, ArenaMemory);
+
+    particle_system SSE;
+    particle_system AVX2;
+    InitializeParticleSystem(&SSE, &Arena, ParticleCount, 5678);
+    InitializeParticleSystem(&AVX2, &Arena, ParticleCount, 5678);
+    BenchSpawnParticles(&SSE, ParticleCount);
+    BenchSpawnParticles(&AVX2, ParticleCount);
+
+    particle_sim_spec Spec = {};
+    Spec.ddPY = 400.0f;
+    Spec.Drag = 0.5f;
+    Spec.FloorY = (real32) (BENCH_HEIGHT - 2);
+    Spec.Restitution = 0.5f;
+    real32 dt = 1.0f / (real32) BENCH_UPDATE_HZ;
+
+    char Name[96];
+    bench_timer SSETimer = {};
+    for (int Sample = 0; Sample < BenchSampleCount(SampleCount); ++Sample) {
+        BenchBeginSample(&SSETimer);
+        SimulateParticlesSSE(&SSE, &Spec, dt);
+        BenchEndSample(&SSETimer);
+    }
+    snprintf(Name, sizeof(Name), "%s_simulate_sse", Prefix);
+    BenchFinish(&SSETimer, Name, "cycles/particle", (real64) ParticleCount);
+
+    if (AVX2.UseAVX2) {
+        bench_timer AVX2Timer = {};
+        for (int Sample = 0; Sample < BenchSampleCount(SampleCount); ++Sample) {
+            BenchBeginSample(&AVX2Timer);
+            SimulateParticlesAVX2(&AVX2, &Spec, dt);
+            BenchEndSample(&AVX2Timer);
+        }
+        snprintf(Name, sizeof(Name), "%s_simulate_avx2", Prefix);
+        BenchFinish(&AVX2Timer, Name, "cycles/particle", (real64) ParticleCount);
+
+        // NOTE: same operations in the same order, so the results must match exactly
+        memory_index ArraySize = ParticlePaddedCount(ParticleCount) * sizeof(real32);
+        if ((memcmp(SSE.PosX, AVX2.PosX, ArraySize) != 0) ||
+            (memcmp(SSE.PosY, AVX2.PosY, ArraySize) != 0) ||
+            (memcmp(SSE.VelX, AVX2.VelX, ArraySize) != 0) ||
+            (memcmp(SSE.VelY, AVX2.VelY, ArraySize) != 0) ||
+            (memcmp(SSE.Life, AVX2.Life, ArraySize) != 0)) {
+            BenchFail("%s: AVX2 simulation differs from SSE\n", Prefix);
+        }
+    } else {
+        fprintf(stderr, "%s: no AVX2 on this CPU, skipping the AVX2 kernel\n", Prefix);
+    }
+
+    game_offscreen_buffer Buffer = {};
+    Buffer.Width = BENCH_WIDTH;
+    Buffer.Height = BENCH_HEIGHT;
+    Buffer.Pitch = BENCH_WIDTH * 4;
+    Buffer.Memory = calloc(BENCH_WIDTH * BENCH_HEIGHT, 4);
+
+    // NOTE: re-spread the particles the simulation piled onto the floor
+    SSE.Count = 0;
+    BenchSpawnParticles(&SSE, ParticleCount);
+
+    bench_timer DrawTimer = {};
+    for (int Sample = 0; Sample < BenchSampleCount(SampleCount); ++Sample) {
+        memset(Buffer.Memory, 0, BENCH_WIDTH * BENCH_HEIGHT * 4);
+        BenchBeginSample(&DrawTimer);
+        DrawParticles(&Buffer, &SSE);
+        BenchEndSample(&DrawTimer);
+    }
+    snprintf(Name, sizeof(Name), "%s_draw", Prefix);
+    BenchFinish(&DrawTimer, Name, "cycles/particle", (real64) ParticleCount);
+
+    bench_timer FrameTimer = {};
+    for (int Sample = 0; Sample < BenchSampleCount(SampleCount); ++Sample) {
+        uint64 Start = BenchReadNanoseconds();
+        SimulateParticles(&SSE, &Spec, dt);
+        DrawParticles(&Buffer, &SSE);
+        BenchAddSample(&FrameTimer, BenchReadNanoseconds() - Start);
+    }
+    snprintf(Name, sizeof(Name), "%s_frame", Prefix);
+    BenchFinish(&FrameTimer, Name, "ms/frame", 1000000.0);
+
+    real64 MedianMS = (real64) FrameTimer.Samples[FrameTimer.SampleCount / 2] / 1000000.0;
+    real64 BudgetMS = 1000.0 / (real64) BENCH_UPDATE_HZ;
+    if (MedianMS > BudgetMS) {
+        BenchFail("%s: %.02fms per frame is over the %.02fms budget\n", Prefix, MedianMS, BudgetMS);
+    }
+
+    free(Buffer.Memory);
+    free(ArenaMemory);
+}
+
+internal void
+BenchSpatialGrid(uint32 ObjectCount, int SampleCount) {
+    char Prefix[64];
+    snprintf(Prefix, sizeof(Prefix), "spatial_grid_%u", ObjectCount);
+    if (!BenchShouldRun(Prefix)) {
+        return;
+    }
+
+    memory_index ArenaSize = Megabytes(256);
+    void* ArenaMemory = calloc(ArenaSize, 1);
+    memory_arena Arena;
+    InitializeArena(&Arena, ArenaSize, ArenaMemory);
+
+    // NOTE: keep the density the game runs at (16k objects in 640x480)
+    real32 WorldSize = sqrtf((real32) ObjectCount * (640.0f * 480.0f / 16384.0f));
+    real32 CellSize = 4.0f;
+    real32 Radius = 2.0f;
+
+    real32* PosX = PushArray(&Arena, ObjectCount, real32);
+    real32* PosY = PushArray(&Arena, ObjectCount, real32);
+    random_series Series = RandomSeed(5678);
+    for (uint32 Index = 0; Index < ObjectCount; ++Index) {
+        PosX[Index] = RandomBetween(&Series, 0.0f, WorldSize);
+        PosY[Index] = RandomBetween(&Series, 0.0f, WorldSize);
+    }
+
+    uint32 MaxPairs = 8 * ObjectCount;
+    spatial_pair* Pairs = PushArray(&Arena, MaxPairs, spatial_pair);
+    uint32 MaxResults = 4096;
+    uint32* Results = PushArray(&Arena, MaxResults, uint32);
+    uint32 QueryCount = 1024;
+    real32* QueryX = PushArray(&Arena, QueryCount, real32);
+    real32* QueryY = PushArray(&Arena, QueryCount, real32);
+    for (uint32 Query = 0; Query < QueryCount; ++Query) {
+        QueryX[Query] = RandomBetween(&Series, 0.0f, WorldSize);
+        QueryY[Query] = RandomBetween(&Series, 0.0f, WorldSize);
+    }
+
+    bench_timer BuildTimer = {};
+    bench_timer PairTimer = {};
+    bench_timer RangeTimer = {};
+    bench_timer NeighborTimer = {};
+    uint32 PairCount = 0;
+    uint32 QueryHits = 0;
+    for (int Sample = 0; Sample < BenchSampleCount(SampleCount); ++Sample) {
+        temporary_memory GridMemory = BeginTemporaryMemory(&Arena);
+        spatial_grid Grid;
+
+        BenchBeginSample(&BuildTimer);
+        BuildSpatialGrid(&Grid, &Arena, ObjectCount, PosX, PosY, CellSize);
+        BenchEndSample(&BuildTimer);
+
+        BenchBeginSample(&PairTimer);
+        PairCount = FindSpatialGridPairs(&Grid, Radius, Pairs, MaxPairs);
+        BenchEndSample(&PairTimer);
+
+        BenchBeginSample(&RangeTimer);
+        for (uint32 Query = 0; Query < QueryCount; ++Query) {
+            QueryHits += QuerySpatialGridRange(&Grid, QueryX[Query], QueryY[Query],
+                                               QueryX[Query] + 32.0f, QueryY[Query] + 32.0f,
+                                               Results, MaxResults);
+        }
+        BenchEndSample(&RangeTimer);
+
+        BenchBeginSample(&NeighborTimer);
+        for (uint32 Query = 0; Query < QueryCount; ++Query) {
+            QueryHits += QuerySpatialGridNeighbors(&Grid, PosX[Query], PosY[Query], Radius,
+                                                   Results, MaxResults);
+        }
+        BenchEndSample(&NeighborTimer);
+
+        EndTemporaryMemory(GridMemory);
+    }
+    GlobalBenchSink = (real32) QueryHits;
+
+    char Name[96];
+    snprintf(Name, sizeof(Name), "%s_build", Prefix);
+    BenchFinish(&BuildTimer, Name, "cycles/object", (real64) ObjectCount);
+    snprintf(Name, sizeof(Name), "%s_pairs", Prefix);
+    BenchFinish(&PairTimer, Name, "cycles/object", (real64) ObjectCount);
+    snprintf(Name, sizeof(Name), "%s_range", Prefix);
+    BenchFinish(&RangeTimer, Name, "cycles/query", (real64) QueryCount);
+    snprintf(Name, sizeof(Name), "%s_neighbors", Prefix);
+    BenchFinish(&NeighborTimer, Name, "cycles/query", (real64) QueryCount);
+
+    if (ObjectCount <= 10000) {
+        // NOTE: brute force cross-check of the pair count
+        uint32 BruteForcePairCount = 0;
+        for (uint32 A = 0; A < ObjectCount; ++A) {
+            for (uint32 B = A + 1; B < ObjectCount; ++B) {
+                real32 dX = PosX[B] - PosX[A];
+                real32 dY = PosY[B] - PosY[A];
+                if ((dX * dX + dY * dY) <= Radius * Radius) {
+                    ++BruteForcePairCount;
+                }
+            }
+        }
+        if (BruteForcePairCount != PairCount) {
+            BenchFail("%s MISMATCH: grid found %u pairs, brute force %u\n",
+                      Prefix, PairCount, BruteForcePairCount);
+        }
+    }
+
+    free(ArenaMemory);
+}
+
+internal bool32
+BenchWriteTestWave(char* Filename, uint32 SamplesPerSecond, uint32 ChannelCount, uint32 Seconds) {
+    uint32 FrameCount = SamplesPerSecond * Seconds;
+    uint32 DataSize = FrameCount * ChannelCount * sizeof(int16);
+    uint32 FileSize = sizeof(wave_header) + 2 * sizeof(wave_chunk) + sizeof(wave_fmt) + DataSize;
+    uint8* File = (uint8*) calloc(FileSize, 1);
+
+    wave_header* Header = (wave_header*) File;
+    Header->RiffID = WAVE_ChunkID_RIFF;
+    Header->Size = FileSize - 8;
+    Header->WaveID = WAVE_ChunkID_WAVE;
+
+    wave_chunk* FormatChunk = (wave_chunk*) (Header + 1);
+    FormatChunk->ID = WAVE_ChunkID_fmt;
+    FormatChunk->Size = sizeof(wave_fmt);
+    wave_fmt* Format = (wave_fmt*) (FormatChunk + 1);
+    Format->wFormatTag = 1;
+    Format->nChannels = ChannelCount;
+    Format->nSamplesPerSec = SamplesPerSecond;
+    Format->nAvgBytesPerSec = SamplesPerSecond * ChannelCount * sizeof(int16);
+    Format->nBlockAlign = ChannelCount * sizeof(int16);
+    Format->wBitsPerSample = 16;
+
+    wave_chunk* DataChunk = (wave_chunk*) (Format + 1);
+    DataChunk->ID = WAVE_ChunkID_data;
+    DataChunk->Size = DataSize;
+    int16* Samples = (int16*) (DataChunk + 1);
+    for (uint32 FrameIndex = 0; FrameIndex < FrameCount; ++FrameIndex) {
+        int16 Value = (int16) (3000.0f * sinf(2.0f * Pi32 * 440.0f * (real32) FrameIndex / (real32) SamplesPerSecond));
+        for (uint32 Channel = 0; Channel < ChannelCount; ++Channel) {
+            *Samples++ = Value;
+        }
+    }
+
+    bool32 Result = DEBUGPlatformWriteEntireFile(Filename, FileSize, File);
+    free(File);
+    return (Result);
+}
+
+internal void
+BenchStreamingSound(uint32 SamplesPerSecond, uint32 ChannelCount) {
+    char Prefix[64];
+    snprintf(Prefix, sizeof(Prefix), "stream_%uhz_%uch", SamplesPerSecond, ChannelCount);
+    if (!BenchShouldRun(Prefix)) {
+        return;
+    }
+
+    char Filename[] = "bench_stream.wav";
+    if (!BenchWriteTestWave(Filename, SamplesPerSecond, ChannelCount, 10)) {
+        fprintf(stderr, "%s: couldn't write %s\n", Prefix, Filename);
+        return;
+    }
+
+    memory_index ArenaSize = Megabytes(1);
+    void* ArenaMemory = calloc(ArenaSize, 1);
+    memory_arena Arena;
+    InitializeArena(&Arena, ArenaSize, ArenaMemory);
+
+    int OutputSamplesPerSecond = 48000;
+    game_sound_output_buffer SoundBuffer = {};
+    SoundBuffer.SamplesPerSecond = OutputSamplesPerSecond;
+    SoundBuffer.SampleCount = OutputSamplesPerSecond / BENCH_UPDATE_HZ;
+    SoundBuffer.Samples = (int16*) calloc(OutputSamplesPerSecond, sizeof(int16) * 2);
+
+    // NOTE: looping, so the samples never run off the end of the file
+    streaming_sound Sound;
+    OpenStreamingSound(&Sound, &Arena, Filename, true);
+    memory_index BufferedBytes = Arena.Used;
+
+    bench_timer DecodeTimer = {};
+    for (int Sample = 0; Sample < BenchSampleCount(64); ++Sample) {
+        BenchBeginSample(&DecodeTimer);
+        FillStreamingSoundHalf(&Sound, Sample & 1);
+        BenchEndSample(&DecodeTimer);
+    }
+
+    bench_timer PlaybackTimer = {};
+    for (int Sample = 0; Sample < BenchSampleCount(128); ++Sample) {
+        BenchBeginSample(&PlaybackTimer);
+        OutputStreamingSound(0, &SoundBuffer, &Sound, 1.0f);
+        BenchEndSample(&PlaybackTimer);
+    }
+    CloseStreamingSound(0, &Sound);
+
+    // NOTE: the game refills through the job system; it has to sound the same
+    // as filling inline, across a few wraps of the window
+    game_memory JobMemory = {};
+    if (GlobalBenchJobSystem.Workers) {
+        SDLConnectJobSystem(&JobMemory, &GlobalBenchJobSystem);
+    }
+    streaming_sound InlineSound;
+    streaming_sound JobSound;
+    OpenStreamingSound(&InlineSound, &Arena, Filename, true);
+    OpenStreamingSound(&JobSound, &Arena, Filename, true);
+    int16* JobSamples = (int16*) calloc(OutputSamplesPerSecond, sizeof(int16) * 2);
+    game_sound_output_buffer JobBuffer = SoundBuffer;
+    JobBuffer.Samples = JobSamples;
+    memory_index FrameSize = (memory_index) SoundBuffer.SampleCount * 2 * sizeof(int16);
+    int MismatchFrame = -1;
+    for (int Frame = 0; (MismatchFrame < 0) && (Frame < 4 * BENCH_UPDATE_HZ); ++Frame) {
+        OutputStreamingSound(0, &SoundBuffer, &InlineSound, 1.0f);
+        OutputStreamingSound(&JobMemory, &JobBuffer, &JobSound, 1.0f);
+        if (memcmp(SoundBuffer.Samples, JobSamples, FrameSize) != 0) {
+            MismatchFrame = Frame;
+        }
+    }
+    CloseStreamingSound(0, &InlineSound);
+    CloseStreamingSound(&JobMemory, &JobSound);
+    if (MismatchFrame >= 0) {
+        BenchFail("%s: refilling from a job differs from inline at frame %d\n", Prefix, MismatchFrame);
+    }
+
+    // NOTE: after a stall the platform asks for up to the whole second in its
+    // ring at once, several chunks of source; that has to come out the same
+    // as the same second asked for a frame at a time
+    streaming_sound StalledSound;
+    streaming_sound SteadySound;
+    OpenStreamingSound(&StalledSound, &Arena, Filename, true);
+    OpenStreamingSound(&SteadySound, &Arena, Filename, true);
+    game_sound_output_buffer StalledBuffer = JobBuffer;
+    StalledBuffer.SampleCount = OutputSamplesPerSecond;
+    OutputStreamingSound(&JobMemory, &StalledBuffer, &StalledSound, 1.0f);
+    game_sound_output_buffer SteadyBuffer = SoundBuffer;
+    for (int Frame = 0; Frame < BENCH_UPDATE_HZ; ++Frame) {
+        SteadyBuffer.Samples = SoundBuffer.Samples + 2 * Frame * SoundBuffer.SampleCount;
+        OutputStreamingSound(0, &SteadyBuffer, &SteadySound, 1.0f);
+    }
+    CloseStreamingSound(&JobMemory, &StalledSound);
+    CloseStreamingSound(0, &SteadySound);
+    if (memcmp(SoundBuffer.Samples, JobSamples, (memory_index) OutputSamplesPerSecond * 2 * sizeof(int16)) != 0) {
+        BenchFail("%s: a whole second at once differs from a frame at a time\n", Prefix);
+    }
+    free(JobSamples);
+
+    char Name[96];
+    snprintf(Name, sizeof(Name), "%s_decode", Prefix);
+    BenchFinish(&DecodeTimer, Name, "cycles/audio_second",
+                (real64) STREAM_CHUNK_FRAMES / (real64) SamplesPerSecond);
+    snprintf(Name, sizeof(Name), "%s_playback", Prefix);
+    BenchFinish(&PlaybackTimer, Name, "cycles/audio_second",
+                (real64) SoundBuffer.SampleCount / (real64) OutputSamplesPerSecond);
+    snprintf(Name, sizeof(Name), "%s_buffered", Prefix);
+    BenchRecord(Name, "bytes", (real64) BufferedBytes, (real64) BufferedBytes);
+
+    free(SoundBuffer.Samples);
+    free(ArenaMemory);
+    unlink(Filename);
+}
+
+//
+// NOTE: baselines
+//
+
+internal bool32
+BenchWriteBaseline(char* Filename) {
+    FILE* File = fopen(Filename, "w");
+    if (!File) {
+        return false;
+    }
+
+    fprintf(File, "name,unit,min,median\n");
+    for (uint32 ResultIndex = 0; ResultIndex < GlobalBench.ResultCount; ++ResultIndex) {
+        bench_result* Result = &GlobalBench.Results[ResultIndex];
+        fprintf(File, "%s,%s,%.03f,%.03f\n", Result->Name, Result->Unit, Result->Min, Result->Median);
+    }
+
+    fclose(File);
+    return true;
+}
+
+/*
+ * Returns the number of results whose median got slower than the baseline by
+ * more than ThresholdPercent. Benchmarks missing from either side are skipped.
+ */
+internal int
+BenchCompareBaseline(char* Filename, real64 ThresholdPercent) {
+    FILE* File = fopen(Filename, "r");
+    if (!File) {
+        fprintf(stderr, "couldn't open baseline %s\n", Filename);
+        return 1;
+    }
+
+    int RegressionCount = 0;
+    char Line[256];
+    while (fgets(Line, sizeof(Line), File)) {
+        bench_result Baseline = {};
+        if (sscanf(Line, "%63[^,],%31[^,],%lf,%lf", Baseline.Name, Baseline.Unit,
+                   &Baseline.Min, &Baseline.Median) != 4) {
+            continue;
+        }
+
+        for (uint32 ResultIndex = 0; ResultIndex < GlobalBench.ResultCount; ++ResultIndex) {
+            bench_result* Result = &GlobalBench.Results[ResultIndex];
+            if ((strcmp(Result->Name, Baseline.Name) != 0) || (Baseline.Median <= 0.0)) {
+                continue;
+            }
+
+            real64 ChangePercent = 100.0 * (Result->Median - Baseline.Median) / Baseline.Median;
+            if (ChangePercent > ThresholdPercent) {
+                fprintf(stderr, "REGRESSION %s: %.03f -> %.03f %s (+%.01f%%)\n",
+                        Result->Name, Baseline.Median, Result->Median, Result->Unit, ChangePercent);
+                ++RegressionCount;
+            }
+        }
+    }
+
+    fclose(File);
+    return (RegressionCount);
+}
+
+int main(int argc, char* argv[]) {
+    char* BaselineFilename = 0;
+    char* WriteBaselineFilename = 0;
+    real64 ThresholdPercent = 10.0;
+    for (int ArgIndex = 1; ArgIndex < argc; ++ArgIndex) {
+        bool32 HasValue = (ArgIndex + 1 < argc);
+        if (HasValue && (strcmp(argv[ArgIndex], "--filter") == 0)) {
+            GlobalBench.Filter = argv[++ArgIndex];
+        } else if (HasValue && (strcmp(argv[ArgIndex], "--baseline") == 0)) {
+            BaselineFilename = argv[++ArgIndex];
+        } else if (HasValue && (strcmp(argv[ArgIndex], "--write-baseline") == 0)) {
+            WriteBaselineFilename = argv[++ArgIndex];
+        } else if (HasValue && (strcmp(argv[ArgIndex], "--threshold") == 0)) {
+            ThresholdPercent = atof(argv[++ArgIndex]);
+        } else {
+            fprintf(stderr, "usage: %s [--filter TEXT] [--baseline FILE] [--write-baseline FILE] "
+                            "[--threshold PERCENT]\n", argv[0]);
+            return (2);
+        }
+    }
+
+    BenchPinToCurrentCPU();
+    long CoreCount = sysconf(_SC_NPROCESSORS_ONLN);
+    BenchInitJobSystem(&GlobalBenchJobSystem, (CoreCount > 0) ? (uint32) CoreCount : 1);
+    printf("name,unit,min,median\n");
+
+    BenchRenderWeirdGradient();
+    BenchGameOutputSound();
+    BenchSDLFillSoundBuffer();
+    BenchSDLAudioCallback();
+    BenchSDLProcessGameControllerAxisValue();
+
+    BenchEntityLayouts(1024, 256);
+    BenchEntityLayouts(16384, 128);
+    BenchEntityLayouts(65536, 64);
+    BenchEntityLayouts(262144, 16);
+    BenchEntityHandles(4096, 32);
+    BenchParticles(131072, 32);
+
+    BenchSpatialGrid(10000, 32);
+    BenchSpatialGrid(30000, 16);
+    BenchSpatialGrid(100000, 8);
+
+    BenchStreamingSound(44100, 2);
+    BenchStreamingSound(22050, 1);
+    BenchStreamingSound(96000, 2);
+
+    BenchJobSystem();
+    BenchArenaCommit();
+    BenchCapture();
+    BenchFileWatcher();
+    BenchDrawLayouts();
+
+    BenchHeadlessFrames(128);
+    BenchStartup(false, 16);
+    BenchStartup(true, 16);
+    BenchPresent(1, 128);
+    BenchPresent(2, 128);
+    BenchPresent(3, 128);
+
+    SDLShutdownJobSystem(&GlobalBenchJobSystem);
+
+    if (WriteBaselineFilename && !BenchWriteBaseline(WriteBaselineFilename)) {
+        fprintf(stderr, "couldn't write baseline %s\n", WriteBaselineFilename);
+        return (1);
+    }
+
+    int Result = 0;
+    if (GlobalBench.FailureCount) {
+        fprintf(stderr, "%u cross-checks failed\n", GlobalBench.FailureCount);
+        Result = 1;
+    }
+    if (BaselineFilename && (BenchCompareBaseline(BaselineFilename, ThresholdPercent) > 0)) {
+        Result = 1;
+    }
+
+    return (Result);
+}
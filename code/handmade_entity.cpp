@@ -0,0 +1,187 @@
+
+inline uint32
+EntityPaddedCount(uint32 Count) {
+    uint32 Result = (Count + (ENTITY_LANE_COUNT - 1)) & ~(ENTITY_LANE_COUNT - 1);
+    return (Result);
+}
+
+internal void
+InitializeEntityStore(entity_store* Store, memory_arena* Arena, uint32 MaxCount) {
+    uint32 PaddedCount = EntityPaddedCount(MaxCount);
+
+    Store->MaxCount = MaxCount;
+    Store->Count = 0;
+
+    // NOTE: arena memory comes from PermanentStorage, which is cleared to zero,
+    // so the padding lanes start out with no flags set.
+    Store->PosX = PushAlignedArray(Arena, PaddedCount, real32, ENTITY_ARRAY_ALIGNMENT);
+    Store->PosY = PushAlignedArray(Arena, PaddedCount, real32, ENTITY_ARRAY_ALIGNMENT);
+    Store->VelX = PushAlignedArray(Arena, PaddedCount, real32, ENTITY_ARRAY_ALIGNMENT);
+    Store->VelY = PushAlignedArray(Arena, PaddedCount, real32, ENTITY_ARRAY_ALIGNMENT);
+    Store->Flags = PushAlignedArray(Arena, PaddedCount, uint32, ENTITY_ARRAY_ALIGNMENT);
+    Store->Color = PushAlignedArray(Arena, PaddedCount, uint32, ENTITY_ARRAY_ALIGNMENT);
+    Store->DenseToSlot = PushArray(Arena, MaxCount, uint32);
+
+    Store->SlotToDense = PushArray(Arena, MaxCount, uint32);
+    Store->SlotGeneration = PushArray(Arena, MaxCount, uint32);
+    for (uint32 SlotIndex = 0; SlotIndex < MaxCount; ++SlotIndex) {
+        Store->SlotToDense[SlotIndex] = SlotIndex + 1;
+        Store->SlotGeneration[SlotIndex] = 1;
+    }
+    Store->FirstFreeSlot = 0;
+}
+
+internal entity_handle
+AddEntity(entity_store* Store, real32 PosX, real32 PosY, real32 VelX, real32 VelY,
+          uint32 Flags, uint32 Color) {
+    entity_handle Result = {};
+
+    if (Store->FirstFreeSlot < Store->MaxCount) {
+        uint32 Slot = Store->FirstFreeSlot;
+        Store->FirstFreeSlot = Store->SlotToDense[Slot];
+
+        uint32 Index = Store->Count++;
+        Store->PosX[Index] = PosX;
+        Store->PosY[Index] = PosY;
+        Store->VelX[Index] = VelX;
+        Store->VelY[Index] = VelY;
+        Store->Flags[Index] = Flags;
+        Store->Color[Index] = Color;
+        Store->DenseToSlot[Index] = Slot;
+
+        Store->SlotToDense[Slot] = Index;
+
+        Result.Slot = Slot;
+        Result.Generation = Store->SlotGeneration[Slot];
+    }
+
+    return (Result);
+}
+
+inline uint32
+GetEntityIndex(entity_store* Store, entity_handle Handle) {
+    uint32 Result = ENTITY_INVALID_INDEX;
+
+    if ((Handle.Slot < Store->MaxCount) &&
+        (Handle.Generation != 0) &&
+        (Store->SlotGeneration[Handle.Slot] == Handle.Generation)) {
+        Result = Store->SlotToDense[Handle.Slot];
+    }
+
+    return (Result);
+}
+
+internal bool32
+RemoveEntity(entity_store* Store, entity_handle Handle) {
+    uint32 Index = GetEntityIndex(Store, Handle);
+    if (Index == ENTITY_INVALID_INDEX) {
+        return false;
+    }
+
+    uint32 LastIndex = --Store->Count;
+    if (Index != LastIndex) {
+        Store->PosX[Index] = Store->PosX[LastIndex];
+        Store->PosY[Index] = Store->PosY[LastIndex];
+        Store->VelX[Index] = Store->VelX[LastIndex];
+        Store->VelY[Index] = Store->VelY[LastIndex];
+        Store->Flags[Index] = Store->Flags[LastIndex];
+        Store->Color[Index] = Store->Color[LastIndex];
+
+        uint32 MovedSlot = Store->DenseToSlot[LastIndex];
+        Store->DenseToSlot[Index] = MovedSlot;
+        Store->SlotToDense[MovedSlot] = Index;
+    }
+
+    // NOTE: the vacated lane becomes padding again, and padding must stay inert
+    Store->PosX[LastIndex] = 0.0f;
+    Store->PosY[LastIndex] = 0.0f;
+    Store->VelX[LastIndex] = 0.0f;
+    Store->VelY[LastIndex] = 0.0f;
+    Store->Flags[LastIndex] = 0;
+    Store->Color[LastIndex] = 0;
+
+    if (++Store->SlotGeneration[Handle.Slot] == 0) {
+        Store->SlotGeneration[Handle.Slot] = 1;
+    }
+    Store->SlotToDense[Handle.Slot] = Store->FirstFreeSlot;
+    Store->FirstFreeSlot = Handle.Slot;
+
+    return true;
+}
+
+inline __m128
+SelectPS(__m128 Mask, __m128 IfTrue, __m128 IfFalse) {
+    __m128 Result = _mm_or_ps(_mm_and_ps(Mask, IfTrue), _mm_andnot_ps(Mask, IfFalse));
+    return (Result);
+}
+
+/*
+ * ddP = Accel - Drag*V
+ * P' = P + 0.5*ddP*dt^2 + V*dt
+ * V' = V + ddP*dt
+ *
+ * Entities flagged to bounce are clamped to the bounds with the offending
+ * velocity component reflected. Entities without EntityFlag_Moving (including
+ * the padding lanes) are left untouched.
+ */
+internal void
+MoveEntities(entity_store* Store, entity_move_spec* Spec, real32 dt) {
+    __m128 dt_4x = _mm_set1_ps(dt);
+    __m128 HalfdtSq_4x = _mm_set1_ps(0.5f * dt * dt);
+    __m128 AccelX_4x = _mm_set1_ps(Spec->ddPX);
+    __m128 AccelY_4x = _mm_set1_ps(Spec->ddPY);
+    __m128 Drag_4x = _mm_set1_ps(Spec->Drag);
+    __m128 MinX_4x = _mm_set1_ps(Spec->MinX);
+    __m128 MinY_4x = _mm_set1_ps(Spec->MinY);
+    __m128 MaxX_4x = _mm_set1_ps(Spec->MaxX);
+    __m128 MaxY_4x = _mm_set1_ps(Spec->MaxY);
+    __m128 SignBit_4x = _mm_set1_ps(-0.0f);
+    __m128i MovingFlag_4x = _mm_set1_epi32(EntityFlag_Moving);
+    __m128i BouncesFlag_4x = _mm_set1_epi32(EntityFlag_Bounces);
+
+    uint32 PaddedCount = EntityPaddedCount(Store->Count);
+    for (uint32 Index = 0; Index < PaddedCount; Index += ENTITY_LANE_COUNT) {
+        __m128 PosX = _mm_load_ps(Store->PosX + Index);
+        __m128 PosY = _mm_load_ps(Store->PosY + Index);
+        __m128 VelX = _mm_load_ps(Store->VelX + Index);
+        __m128 VelY = _mm_load_ps(Store->VelY + Index);
+        __m128i Flags = _mm_load_si128((__m128i*) (Store->Flags + Index));
+
+        __m128 Moving = _mm_castsi128_ps(
+                _mm_cmpeq_epi32(_mm_and_si128(Flags, MovingFlag_4x), MovingFlag_4x));
+        __m128 Bounces = _mm_castsi128_ps(
+                _mm_cmpeq_epi32(_mm_and_si128(Flags, BouncesFlag_4x), BouncesFlag_4x));
+
+        __m128 ddPX = _mm_sub_ps(AccelX_4x, _mm_mul_ps(Drag_4x, VelX));
+        __m128 ddPY = _mm_sub_ps(AccelY_4x, _mm_mul_ps(Drag_4x, VelY));
+
+        __m128 NewPosX = _mm_add_ps(PosX, _mm_add_ps(_mm_mul_ps(HalfdtSq_4x, ddPX), _mm_mul_ps(dt_4x, VelX)));
+        __m128 NewPosY = _mm_add_ps(PosY, _mm_add_ps(_mm_mul_ps(HalfdtSq_4x, ddPY), _mm_mul_ps(dt_4x, VelY)));
+        __m128 NewVelX = _mm_add_ps(VelX, _mm_mul_ps(dt_4x, ddPX));
+        __m128 NewVelY = _mm_add_ps(VelY, _mm_mul_ps(dt_4x, ddPY));
+
+        __m128 OutX = _mm_and_ps(Bounces, _mm_or_ps(_mm_cmplt_ps(NewPosX, MinX_4x), _mm_cmpgt_ps(NewPosX, MaxX_4x)));
+        __m128 OutY = _mm_and_ps(Bounces, _mm_or_ps(_mm_cmplt_ps(NewPosY, MinY_4x), _mm_cmpgt_ps(NewPosY, MaxY_4x)));
+        NewPosX = SelectPS(OutX, _mm_min_ps(_mm_max_ps(NewPosX, MinX_4x), MaxX_4x), NewPosX);
+        NewPosY = SelectPS(OutY, _mm_min_ps(_mm_max_ps(NewPosY, MinY_4x), MaxY_4x), NewPosY);
+        NewVelX = _mm_xor_ps(NewVelX, _mm_and_ps(OutX, SignBit_4x));
+        NewVelY = _mm_xor_ps(NewVelY, _mm_and_ps(OutY, SignBit_4x));
+
+        _mm_store_ps(Store->PosX + Index, SelectPS(Moving, NewPosX, PosX));
+        _mm_store_ps(Store->PosY + Index, SelectPS(Moving, NewPosY, PosY));
+        _mm_store_ps(Store->VelX + Index, SelectPS(Moving, NewVelX, VelX));
+        _mm_store_ps(Store->VelY + Index, SelectPS(Moving, NewVelY, VelY));
+    }
+}
+
+internal void
+DrawEntities(game_offscreen_buffer* Buffer, entity_store* Store) {
+    for (uint32 Index = 0; Index < Store->Count; ++Index) {
+        int X = (int) Store->PosX[Index];
+        int Y = (int) Store->PosY[Index];
+        if ((X >= 0) && (X < Buffer->Width) && (Y >= 0) && (Y < Buffer->Height)) {
+            uint32* Pixel = GetPixelPointer(Buffer, X, Y);
+            *Pixel = Store->Color[Index];
+        }
+    }
+}
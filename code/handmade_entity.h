@@ -0,0 +1,61 @@
+#if !defined(HANDMADE_ENTITY_H)
+
+/*
+ * Entities are stored as parallel arrays (structure-of-arrays) so the movement
+ * kernels can stream over exactly the components they touch, ENTITY_LANE_COUNT
+ * entities at a time.
+ *
+ * Dense arrays are indexed [0, Count) and stay packed: removing an entity moves
+ * the last one into its place. Game code holds on to entity_handles instead of
+ * dense indices; the slot table maps a handle to wherever its entity lives now.
+ */
+
+#define ENTITY_LANE_COUNT 4
+#define ENTITY_ARRAY_ALIGNMENT 32
+
+#define ENTITY_INVALID_INDEX 0xFFFFFFFF
+
+enum entity_flags {
+    EntityFlag_Moving = (1 << 0),
+    EntityFlag_Bounces = (1 << 1),
+};
+
+struct entity_handle {
+    uint32 Slot;
+    uint32 Generation; // NOTE: 0 is never a live generation, so a cleared handle is invalid
+};
+
+struct entity_store {
+    uint32 MaxCount;
+    uint32 Count;
+
+    // NOTE: each component array holds MaxCount rounded up to ENTITY_LANE_COUNT,
+    // and lanes past Count are kept cleared, so kernels never need a scalar tail.
+    real32* PosX;
+    real32* PosY;
+    real32* VelX;
+    real32* VelY;
+    uint32* Flags;
+    uint32* Color;
+
+    uint32* DenseToSlot;
+
+    // NOTE: for a free slot, SlotToDense holds the next free slot instead
+    uint32* SlotToDense;
+    uint32* SlotGeneration;
+    uint32 FirstFreeSlot;
+};
+
+struct entity_move_spec {
+    real32 ddPX;
+    real32 ddPY;
+    real32 Drag;
+
+    real32 MinX;
+    real32 MinY;
+    real32 MaxX;
+    real32 MaxY;
+};
+
+#define HANDMADE_ENTITY_H
+#endif
@@ -0,0 +1,361 @@
+inline uint32
+ParticlePaddedCount(uint32 Count) {
+    uint32 Result = (Count + (PARTICLE_LANE_COUNT - 1)) & ~(PARTICLE_LANE_COUNT - 1);
+    return (Result);
+}
+
+internal void
+InitializeParticleSystem(particle_system* System, memory_arena* Arena, uint32 MaxCount, uint32 Seed) {
+    uint32 PaddedCount = ParticlePaddedCount(MaxCount);
+
+    System->MaxCount = MaxCount;
+    System->Count = 0;
+
+    // NOTE: the arena is carved out of freshly committed (zeroed) pages, so every
+    // lane starts out with no life
+    System->PosX = PushAlignedArray(Arena, PaddedCount, real32, PARTICLE_ARRAY_ALIGNMENT);
+    System->PosY = PushAlignedArray(Arena, PaddedCount, real32, PARTICLE_ARRAY_ALIGNMENT);
+    System->VelX = PushAlignedArray(Arena, PaddedCount, real32, PARTICLE_ARRAY_ALIGNMENT);
+    System->VelY = PushAlignedArray(Arena, PaddedCount, real32, PARTICLE_ARRAY_ALIGNMENT);
+    System->Life = PushAlignedArray(Arena, PaddedCount, real32, PARTICLE_ARRAY_ALIGNMENT);
+    System->InvMaxLife = PushAlignedArray(Arena, PaddedCount, real32, PARTICLE_ARRAY_ALIGNMENT);
+    System->Color = PushAlignedArray(Arena, PaddedCount, uint32, PARTICLE_ARRAY_ALIGNMENT);
+
+    System->Entropy = RandomSeed(Seed);
+    System->UseAVX2 = __builtin_cpu_supports("avx2");
+}
+
+internal void
+SpawnParticles(particle_system* System, particle_emitter* Emitter, uint32 SpawnCount) {
+    uint32 Available = System->MaxCount - System->Count;
+    if (SpawnCount > Available) {
+        SpawnCount = Available;
+    }
+
+    random_series* Entropy = &System->Entropy;
+    for (uint32 SpawnIndex = 0; SpawnIndex < SpawnCount; ++SpawnIndex) {
+        uint32 Index = System->Count++;
+        real32 Life = RandomBetween(Entropy, Emitter->MinLife, Emitter->MaxLife);
+        System->PosX[Index] = Emitter->PosX;
+        System->PosY[Index] = Emitter->PosY;
+        System->VelX[Index] = Emitter->SpreadX * RandomBilateral(Entropy);
+        System->VelY[Index] = -RandomBetween(Entropy, Emitter->MinSpeedY, Emitter->MaxSpeedY);
+        System->Life[Index] = Life;
+        System->InvMaxLife[Index] = 1.0f / Life;
+        System->Color[Index] = Emitter->Color;
+    }
+}
+
+/*
+ * Same integration as MoveEntities:
+ * ddP = Accel - Drag*V
+ * P' = P + 0.5*ddP*dt^2 + V*dt
+ * V' = V + ddP*dt
+ * and anything below FloorY is put back on it heading up.
+ */
+internal void
+SimulateParticlesSSE(particle_system* System, particle_sim_spec* Spec, real32 dt) {
+    __m128 dt_4x = _mm_set1_ps(dt);
+    __m128 HalfdtSq_4x = _mm_set1_ps(0.5f * dt * dt);
+    __m128 AccelX_4x = _mm_set1_ps(Spec->ddPX);
+    __m128 AccelY_4x = _mm_set1_ps(Spec->ddPY);
+    __m128 Drag_4x = _mm_set1_ps(Spec->Drag);
+    __m128 FloorY_4x = _mm_set1_ps(Spec->FloorY);
+    __m128 Restitution_4x = _mm_set1_ps(Spec->Restitution);
+    __m128 SignBit_4x = _mm_set1_ps(-0.0f);
+
+    uint32 PaddedCount = ParticlePaddedCount(System->Count);
+    for (uint32 Index = 0; Index < PaddedCount; Index += 4) {
+        __m128 PosX = _mm_load_ps(System->PosX + Index);
+        __m128 PosY = _mm_load_ps(System->PosY + Index);
+        __m128 VelX = _mm_load_ps(System->VelX + Index);
+        __m128 VelY = _mm_load_ps(System->VelY + Index);
+        __m128 Life = _mm_load_ps(System->Life + Index);
+
+        __m128 ddPX = _mm_sub_ps(AccelX_4x, _mm_mul_ps(Drag_4x, VelX));
+        __m128 ddPY = _mm_sub_ps(AccelY_4x, _mm_mul_ps(Drag_4x, VelY));
+        PosX = _mm_add_ps(PosX, _mm_add_ps(_mm_mul_ps(HalfdtSq_4x, ddPX), _mm_mul_ps(dt_4x, VelX)));
+        PosY = _mm_add_ps(PosY, _mm_add_ps(_mm_mul_ps(HalfdtSq_4x, ddPY), _mm_mul_ps(dt_4x, VelY)));
+        VelX = _mm_add_ps(VelX, _mm_mul_ps(dt_4x, ddPX));
+        VelY = _mm_add_ps(VelY, _mm_mul_ps(dt_4x, ddPY));
+
+        __m128 Below = _mm_cmpgt_ps(PosY, FloorY_4x);
+        __m128 Bounced = _mm_mul_ps(_mm_or_ps(_mm_andnot_ps(SignBit_4x, VelY), SignBit_4x), Restitution_4x);
+        PosY = SelectPS(Below, FloorY_4x, PosY);
+        VelY = SelectPS(Below, Bounced, VelY);
+
+        _mm_store_ps(System->PosX + Index, PosX);
+        _mm_store_ps(System->PosY + Index, PosY);
+        _mm_store_ps(System->VelX + Index, VelX);
+        _mm_store_ps(System->VelY + Index, VelY);
+        _mm_store_ps(System->Life + Index, _mm_sub_ps(Life, dt_4x));
+    }
+}
+
+// NOTE: compiled for AVX2 regardless of the build flags; only called when
+// the CPU reported it at init
+__attribute__((target("avx2"))) internal void
+SimulateParticlesAVX2(particle_system* System, particle_sim_spec* Spec, real32 dt) {
+    __m256 dt_8x = _mm256_set1_ps(dt);
+    __m256 HalfdtSq_8x = _mm256_set1_ps(0.5f * dt * dt);
+    __m256 AccelX_8x = _mm256_set1_ps(Spec->ddPX);
+    __m256 AccelY_8x = _mm256_set1_ps(Spec->ddPY);
+    __m256 Drag_8x = _mm256_set1_ps(Spec->Drag);
+    __m256 FloorY_8x = _mm256_set1_ps(Spec->FloorY);
+    __m256 Restitution_8x = _mm256_set1_ps(Spec->Restitution);
+    __m256 SignBit_8x = _mm256_set1_ps(-0.0f);
+
+    uint32 PaddedCount = ParticlePaddedCount(System->Count);
+    for (uint32 Index = 0; Index < PaddedCount; Index += 8) {
+        __m256 PosX = _mm256_load_ps(System->PosX + Index);
+        __m256 PosY = _mm256_load_ps(System->PosY + Index);
+        __m256 VelX = _mm256_load_ps(System->VelX + Index);
+        __m256 VelY = _mm256_load_ps(System->VelY + Index);
+        __m256 Life = _mm256_load_ps(System->Life + Index);
+
+        __m256 ddPX = _mm256_sub_ps(AccelX_8x, _mm256_mul_ps(Drag_8x, VelX));
+        __m256 ddPY = _mm256_sub_ps(AccelY_8x, _mm256_mul_ps(Drag_8x, VelY));
+        PosX = _mm256_add_ps(PosX, _mm256_add_ps(_mm256_mul_ps(HalfdtSq_8x, ddPX), _mm256_mul_ps(dt_8x, VelX)));
+        PosY = _mm256_add_ps(PosY, _mm256_add_ps(_mm256_mul_ps(HalfdtSq_8x, ddPY), _mm256_mul_ps(dt_8x, VelY)));
+        VelX = _mm256_add_ps(VelX, _mm256_mul_ps(dt_8x, ddPX));
+        VelY = _mm256_add_ps(VelY, _mm256_mul_ps(dt_8x, ddPY));
+
+        __m256 Below = _mm256_cmp_ps(PosY, FloorY_8x, _CMP_GT_OQ);
+        __m256 Bounced = _mm256_mul_ps(_mm256_or_ps(_mm256_andnot_ps(SignBit_8x, VelY), SignBit_8x),
+                                       Restitution_8x);
+        PosY = _mm256_blendv_ps(PosY, FloorY_8x, Below);
+        VelY = _mm256_blendv_ps(VelY, Bounced, Below);
+
+        _mm256_store_ps(System->PosX + Index, PosX);
+        _mm256_store_ps(System->PosY + Index, PosY);
+        _mm256_store_ps(System->VelX + Index, VelX);
+        _mm256_store_ps(System->VelY + Index, VelY);
+        _mm256_store_ps(System->Life + Index, _mm256_sub_ps(Life, dt_8x));
+    }
+}
+
+/*
+ * Swaps every particle that has run out of life for the last live one.
+ */
+internal void
+RetireParticles(particle_system* System) {
+    for (uint32 Index = 0; Index < System->Count;) {
+        if (System->Life[Index] > 0.0f) {
+            ++Index;
+            continue;
+        }
+
+        uint32 LastIndex = --System->Count;
+        System->PosX[Index] = System->PosX[LastIndex];
+        System->PosY[Index] = System->PosY[LastIndex];
+        System->VelX[Index] = System->VelX[LastIndex];
+        System->VelY[Index] = System->VelY[LastIndex];
+        System->Life[Index] = System->Life[LastIndex];
+        System->InvMaxLife[Index] = System->InvMaxLife[LastIndex];
+        System->Color[Index] = System->Color[LastIndex];
+
+        // NOTE: LastIndex is past Count now, but the kernels keep stepping it
+        // while it shares a vector with live particles; zero it so a retired
+        // particle's state doesn't linger on in the padding
+        System->PosX[LastIndex] = 0.0f;
+        System->PosY[LastIndex] = 0.0f;
+        System->VelX[LastIndex] = 0.0f;
+        System->VelY[LastIndex] = 0.0f;
+        System->Life[LastIndex] = 0.0f;
+        System->InvMaxLife[LastIndex] = 0.0f;
+        System->Color[LastIndex] = 0;
+    }
+}
+
+internal void
+SimulateParticles(particle_system* System, particle_sim_spec* Spec, real32 dt) {
+    if (System->UseAVX2) {
+        SimulateParticlesAVX2(System, Spec, dt);
+    } else {
+        SimulateParticlesSSE(System, Spec, dt);
+    }
+    RetireParticles(System);
+}
+
+/*
+ * Each particle adds a 2x2 splat of its color, faded by the life it has
+ * left, with per-channel saturation.
+ */
+internal void
+DrawParticles(game_offscreen_buffer* Buffer, particle_system* System) {
+    int MaxX = Buffer->Width - 2;
+    int MaxY = Buffer->Height - 2;
+    __m128i Zero = _mm_setzero_si128();
+
+    for (uint32 Index = 0; Index < System->Count; ++Index) {
+        int X = (int) System->PosX[Index];
+        int Y = (int) System->PosY[Index];
+        if ((X < 0) || (X > MaxX) || (Y < 0) || (Y > MaxY)) {
+            continue;
+        }
+
+        real32 Brightness = System->Life[Index] * System->InvMaxLife[Index];
+        __m128i Scale = _mm_set1_epi16((int16) (Brightness * 256.0f));
+        __m128i Color16 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(System->Color[Index]), Zero);
+        __m128i Faded = _mm_packus_epi16(_mm_srli_epi16(_mm_mullo_epi16(Color16, Scale), 8), Zero);
+        __m128i Faded_2x = _mm_unpacklo_epi32(Faded, Faded);
+
+        for (int Row = 0; Row < 2; ++Row) {
+            uint32* Pixel = GetPixelPointer(Buffer, X, Y + Row);
+            if (GetContiguousSpan(Buffer, X) >= 2) {
+                __m128i Pixels = _mm_loadl_epi64((__m128i*) Pixel);
+                _mm_storel_epi64((__m128i*) Pixel, _mm_adds_epu8(Pixels, Faded_2x));
+            } else {
+                // NOTE: the splat straddles a tile edge
+                Pixel[0] = _mm_cvtsi128_si32(_mm_adds_epu8(_mm_cvtsi32_si128(Pixel[0]), Faded));
+                Pixel = GetPixelPointer(Buffer, X + 1, Y + Row);
+                Pixel[0] = _mm_cvtsi128_si32(_mm_adds_epu8(_mm_cvtsi32_si128(Pixel[0]), Faded));
+            }
+        }
+    }
+}
+
+internal void
+DefaultParticleTuning(particle_tuning* Tuning) {
+    *Tuning = {};
+    Tuning->SpawnCount = 2048;
+    Tuning->Emitter.SpreadX = 160.0f;
+    Tuning->Emitter.MinSpeedY = 200.0f;
+    Tuning->Emitter.MaxSpeedY = 400.0f;
+    Tuning->Emitter.MinLife = 1.0f;
+    Tuning->Emitter.MaxLife = 2.5f;
+    Tuning->Emitter.Color = 0xFF102040;
+    Tuning->Spec.ddPY = 400.0f;
+    Tuning->Spec.Drag = 0.5f;
+    Tuning->Spec.Restitution = 0.5f;
+}
+
+inline bool32
+IsTuningSpace(char C) {
+    bool32 Result = ((C == ' ') || (C == '\t') || (C == '\r'));
+    return (Result);
+}
+
+inline bool32
+TuningTokenEquals(char* Token, char* TokenEnd, char const* Match) {
+    while ((Token < TokenEnd) && *Match && (*Token == *Match)) {
+        ++Token;
+        ++Match;
+    }
+    bool32 Result = ((Token == TokenEnd) && (*Match == 0));
+    return (Result);
+}
+
+internal real32
+ParseTuningReal32(char* At, char* End) {
+    real32 Sign = 1.0f;
+    if ((At < End) && (*At == '-')) {
+        Sign = -1.0f;
+        ++At;
+    }
+
+    real32 Result = 0.0f;
+    for (; (At < End) && (*At >= '0') && (*At <= '9'); ++At) {
+        Result = 10.0f * Result + (real32) (*At - '0');
+    }
+    if ((At < End) && (*At == '.')) {
+        real32 Scale = 0.1f;
+        for (++At; (At < End) && (*At >= '0') && (*At <= '9'); ++At) {
+            Result += Scale * (real32) (*At - '0');
+            Scale *= 0.1f;
+        }
+    }
+
+    Result *= Sign;
+    return (Result);
+}
+
+// NOTE: decimal, or hex with a 0x prefix
+internal uint32
+ParseTuningUInt32(char* At, char* End) {
+    uint32 Result = 0;
+    if (((End - At) > 2) && (At[0] == '0') && ((At[1] == 'x') || (At[1] == 'X'))) {
+        for (At += 2; At < End; ++At) {
+            char C = *At;
+            uint32 Digit;
+            if ((C >= '0') && (C <= '9')) {
+                Digit = C - '0';
+            } else if ((C >= 'a') && (C <= 'f')) {
+                Digit = 10 + (C - 'a');
+            } else if ((C >= 'A') && (C <= 'F')) {
+                Digit = 10 + (C - 'A');
+            } else {
+                break;
+            }
+            Result = (Result << 4) | Digit;
+        }
+    } else {
+        for (; (At < End) && (*At >= '0') && (*At <= '9'); ++At) {
+            Result = 10 * Result + (uint32) (*At - '0');
+        }
+    }
+
+    return (Result);
+}
+
+/*
+ * Contents need not be null-terminated. Values override whatever Tuning
+ * already holds, so start from DefaultParticleTuning.
+ */
+internal void
+ParseParticleTuning(particle_tuning* Tuning, char* Contents, uint32 ContentsSize) {
+    char* End = Contents + ContentsSize;
+    for (char* At = Contents; At < End;) {
+        char* LineEnd = At;
+        while ((LineEnd < End) && (*LineEnd != '\n')) {
+            ++LineEnd;
+        }
+
+        char* Name = At;
+        while ((Name < LineEnd) && IsTuningSpace(*Name)) {
+            ++Name;
+        }
+        char* NameEnd = Name;
+        while ((NameEnd < LineEnd) && !IsTuningSpace(*NameEnd)) {
+            ++NameEnd;
+        }
+        char* Value = NameEnd;
+        while ((Value < LineEnd) && IsTuningSpace(*Value)) {
+            ++Value;
+        }
+
+        if ((Name < NameEnd) && (*Name != '#') && (Value < LineEnd)) {
+            if (TuningTokenEquals(Name, NameEnd, "spawn_count")) {
+                Tuning->SpawnCount = ParseTuningUInt32(Value, LineEnd);
+            } else if (TuningTokenEquals(Name, NameEnd, "spread")) {
+                Tuning->Emitter.SpreadX = ParseTuningReal32(Value, LineEnd);
+            } else if (TuningTokenEquals(Name, NameEnd, "min_speed")) {
+                Tuning->Emitter.MinSpeedY = ParseTuningReal32(Value, LineEnd);
+            } else if (TuningTokenEquals(Name, NameEnd, "max_speed")) {
+                Tuning->Emitter.MaxSpeedY = ParseTuningReal32(Value, LineEnd);
+            } else if (TuningTokenEquals(Name, NameEnd, "min_life")) {
+                Tuning->Emitter.MinLife = ParseTuningReal32(Value, LineEnd);
+            } else if (TuningTokenEquals(Name, NameEnd, "max_life")) {
+                Tuning->Emitter.MaxLife = ParseTuningReal32(Value, LineEnd);
+            } else if (TuningTokenEquals(Name, NameEnd, "color")) {
+                Tuning->Emitter.Color = ParseTuningUInt32(Value, LineEnd);
+            } else if (TuningTokenEquals(Name, NameEnd, "gravity")) {
+                Tuning->Spec.ddPY = ParseTuningReal32(Value, LineEnd);
+            } else if (TuningTokenEquals(Name, NameEnd, "drag")) {
+                Tuning->Spec.Drag = ParseTuningReal32(Value, LineEnd);
+            } else if (TuningTokenEquals(Name, NameEnd, "restitution")) {
+                Tuning->Spec.Restitution = ParseTuningReal32(Value, LineEnd);
+            }
+        }
+
+        At = LineEnd + 1;
+    }
+
+    // NOTE: a particle spawned with no life would be retired before it ever drew
+    if (Tuning->Emitter.MinLife <= 0.0f) {
+        Tuning->Emitter.MinLife = 0.01f;
+    }
+    if (Tuning->Emitter.MaxLife < Tuning->Emitter.MinLife) {
+        Tuning->Emitter.MaxLife = Tuning->Emitter.MinLife;
+    }
+}
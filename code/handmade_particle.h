@@ -0,0 +1,78 @@
+#if !defined(HANDMADE_PARTICLE_H)
+
+/*
+ * Particles are short-lived, anonymous and numerous, so unlike entities they
+ * get no handles: the live ones are simply [0, Count) of each array, and a
+ * particle whose life runs out is replaced by the last live one.
+ *
+ * The arrays are padded to PARTICLE_LANE_COUNT and aligned for 8-wide AVX2
+ * loads; the SSE2 kernel just walks them four at a time. Lanes past Count
+ * are padding with no life left, so they never draw.
+ */
+
+#define PARTICLE_LANE_COUNT 8
+#define PARTICLE_ARRAY_ALIGNMENT 32
+
+struct particle_system {
+    uint32 MaxCount;
+    uint32 Count;
+
+    real32* PosX;
+    real32* PosY;
+    real32* VelX;
+    real32* VelY;
+    real32* Life; // NOTE: seconds left
+    real32* InvMaxLife;
+    uint32* Color;
+
+    random_series Entropy;
+    bool32 UseAVX2;
+};
+
+struct particle_emitter {
+    real32 PosX;
+    real32 PosY;
+    real32 SpreadX;
+    real32 MinSpeedY;
+    real32 MaxSpeedY;
+    real32 MinLife;
+    real32 MaxLife;
+    uint32 Color;
+};
+
+struct particle_sim_spec {
+    real32 ddPX;
+    real32 ddPY;
+    real32 Drag;
+
+    // NOTE: particles bounce off this line, losing speed by Restitution
+    real32 FloorY;
+    real32 Restitution;
+};
+
+/*
+ * Hand-editable settings for an emitter, one "name value" pair per line and
+ * '#' starting a comment:
+ *
+ *     spawn_count 2048
+ *     spread 160
+ *     min_speed 200
+ *     max_speed 400
+ *     min_life 1
+ *     max_life 2.5
+ *     color 0xFF102040
+ *     gravity 400
+ *     drag 0.5
+ *     restitution 0.5
+ *
+ * Anything missing or unrecognized keeps its default. Positions and the floor
+ * depend on the buffer size, so they are left to the caller.
+ */
+struct particle_tuning {
+    uint32 SpawnCount;
+    particle_emitter Emitter;
+    particle_sim_spec Spec;
+};
+
+#define HANDMADE_PARTICLE_H
+#endif
@@ -0,0 +1,45 @@
+#if !defined(HANDMADE_RANDOM_H)
+
+// NOTE: xorshift32, good enough for spawning things; not for anything that
+// has to be statistically sound.
+struct random_series {
+    uint32 State;
+};
+
+inline random_series
+RandomSeed(uint32 Value) {
+    random_series Series;
+    Series.State = Value ? Value : 0x9E3779B9;
+    return (Series);
+}
+
+inline uint32
+RandomNextUInt32(random_series* Series) {
+    uint32 Result = Series->State;
+    Result ^= Result << 13;
+    Result ^= Result >> 17;
+    Result ^= Result << 5;
+    Series->State = Result;
+    return (Result);
+}
+
+inline real32
+RandomUnilateral(random_series* Series) {
+    real32 Result = (real32) (RandomNextUInt32(Series) >> 8) * (1.0f / 16777216.0f);
+    return (Result);
+}
+
+inline real32
+RandomBilateral(random_series* Series) {
+    real32 Result = 2.0f * RandomUnilateral(Series) - 1.0f;
+    return (Result);
+}
+
+inline real32
+RandomBetween(random_series* Series, real32 Min, real32 Max) {
+    real32 Result = Min + (Max - Min) * RandomUnilateral(Series);
+    return (Result);
+}
+
+#define HANDMADE_RANDOM_H
+#endif
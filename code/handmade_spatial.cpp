@@ -0,0 +1,219 @@
+
+inline uint32
+SpatialGridBucket(spatial_grid* Grid, int32 CellX, int32 CellY) {
+    uint32 Hash = ((uint32) CellX * 73856093u) ^ ((uint32) CellY * 19349663u);
+    uint32 Result = Hash & Grid->BucketMask;
+    return (Result);
+}
+
+inline int32
+SpatialGridCell(spatial_grid* Grid, real32 Value) {
+    int32 Result = (int32) floorf(Value * Grid->InvCellSize);
+    return (Result);
+}
+
+internal void
+BuildSpatialGrid(spatial_grid* Grid, memory_arena* Arena, uint32 Count,
+                 real32* PosX, real32* PosY, real32 CellSize) {
+    Assert(CellSize > 0.0f);
+
+    uint32 BucketCount = 64;
+    while (BucketCount < 2 * Count) {
+        BucketCount <<= 1;
+    }
+
+    Grid->CellSize = CellSize;
+    Grid->InvCellSize = 1.0f / CellSize;
+    Grid->BucketMask = BucketCount - 1;
+    Grid->Count = Count;
+
+    Grid->BucketStart = PushArray(Arena, BucketCount + 1, uint32);
+    Grid->EntryObject = PushArray(Arena, Count, uint32);
+    Grid->EntryX = PushArray(Arena, Count, real32);
+    Grid->EntryY = PushArray(Arena, Count, real32);
+    Grid->EntryCellX = PushArray(Arena, Count, int32);
+    Grid->EntryCellY = PushArray(Arena, Count, int32);
+    uint32* ObjectBucket = PushArray(Arena, Count, uint32);
+
+    // NOTE: transient memory is reused frame to frame, so clear the counts
+    for (uint32 BucketIndex = 0; BucketIndex <= BucketCount; ++BucketIndex) {
+        Grid->BucketStart[BucketIndex] = 0;
+    }
+
+    for (uint32 ObjectIndex = 0; ObjectIndex < Count; ++ObjectIndex) {
+        uint32 Bucket = SpatialGridBucket(Grid,
+                                          SpatialGridCell(Grid, PosX[ObjectIndex]),
+                                          SpatialGridCell(Grid, PosY[ObjectIndex]));
+        ObjectBucket[ObjectIndex] = Bucket;
+        ++Grid->BucketStart[Bucket];
+    }
+
+    // NOTE: inclusive prefix sum leaves BucketStart[B] at the end of bucket B;
+    // the scatter below walks it back down to the start.
+    uint32 Running = 0;
+    for (uint32 BucketIndex = 0; BucketIndex < BucketCount; ++BucketIndex) {
+        Running += Grid->BucketStart[BucketIndex];
+        Grid->BucketStart[BucketIndex] = Running;
+    }
+    Grid->BucketStart[BucketCount] = Count;
+
+    for (uint32 ObjectIndex = Count; ObjectIndex > 0; --ObjectIndex) {
+        uint32 Object = ObjectIndex - 1;
+        uint32 Entry = --Grid->BucketStart[ObjectBucket[Object]];
+
+        Grid->EntryObject[Entry] = Object;
+        Grid->EntryX[Entry] = PosX[Object];
+        Grid->EntryY[Entry] = PosY[Object];
+        Grid->EntryCellX[Entry] = SpatialGridCell(Grid, PosX[Object]);
+        Grid->EntryCellY[Entry] = SpatialGridCell(Grid, PosY[Object]);
+    }
+}
+
+/*
+ * Both queries return the total number of matches, but only write the first
+ * MaxResults object indices into Results.
+ */
+internal uint32
+QuerySpatialGridRange(spatial_grid* Grid, real32 MinX, real32 MinY, real32 MaxX, real32 MaxY,
+                      uint32* Results, uint32 MaxResults) {
+    uint32 ResultCount = 0;
+
+    int32 MinCellX = SpatialGridCell(Grid, MinX);
+    int32 MinCellY = SpatialGridCell(Grid, MinY);
+    int32 MaxCellX = SpatialGridCell(Grid, MaxX);
+    int32 MaxCellY = SpatialGridCell(Grid, MaxY);
+
+    uint64 CellCount = (uint64) (MaxCellX - MinCellX + 1) * (uint64) (MaxCellY - MinCellY + 1);
+    if (CellCount > Grid->BucketMask) {
+        // NOTE: the box covers more cells than there are buckets, so a straight
+        // scan of the entries touches less memory than walking the cells.
+        for (uint32 Entry = 0; Entry < Grid->Count; ++Entry) {
+            real32 X = Grid->EntryX[Entry];
+            real32 Y = Grid->EntryY[Entry];
+            if ((X >= MinX) && (X <= MaxX) && (Y >= MinY) && (Y <= MaxY)) {
+                if (ResultCount < MaxResults) {
+                    Results[ResultCount] = Grid->EntryObject[Entry];
+                }
+                ++ResultCount;
+            }
+        }
+        return (ResultCount);
+    }
+
+    for (int32 CellY = MinCellY; CellY <= MaxCellY; ++CellY) {
+        for (int32 CellX = MinCellX; CellX <= MaxCellX; ++CellX) {
+            uint32 Bucket = SpatialGridBucket(Grid, CellX, CellY);
+            uint32 OnePastLast = Grid->BucketStart[Bucket + 1];
+            for (uint32 Entry = Grid->BucketStart[Bucket]; Entry < OnePastLast; ++Entry) {
+                if ((Grid->EntryCellX[Entry] != CellX) || (Grid->EntryCellY[Entry] != CellY)) {
+                    continue;
+                }
+
+                real32 X = Grid->EntryX[Entry];
+                real32 Y = Grid->EntryY[Entry];
+                if ((X >= MinX) && (X <= MaxX) && (Y >= MinY) && (Y <= MaxY)) {
+                    if (ResultCount < MaxResults) {
+                        Results[ResultCount] = Grid->EntryObject[Entry];
+                    }
+                    ++ResultCount;
+                }
+            }
+        }
+    }
+
+    return (ResultCount);
+}
+
+internal uint32
+QuerySpatialGridNeighbors(spatial_grid* Grid, real32 CenterX, real32 CenterY, real32 Radius,
+                          uint32* Results, uint32 MaxResults) {
+    uint32 ResultCount = 0;
+    real32 RadiusSq = Radius * Radius;
+
+    int32 MinCellX = SpatialGridCell(Grid, CenterX - Radius);
+    int32 MinCellY = SpatialGridCell(Grid, CenterY - Radius);
+    int32 MaxCellX = SpatialGridCell(Grid, CenterX + Radius);
+    int32 MaxCellY = SpatialGridCell(Grid, CenterY + Radius);
+
+    for (int32 CellY = MinCellY; CellY <= MaxCellY; ++CellY) {
+        for (int32 CellX = MinCellX; CellX <= MaxCellX; ++CellX) {
+            uint32 Bucket = SpatialGridBucket(Grid, CellX, CellY);
+            uint32 OnePastLast = Grid->BucketStart[Bucket + 1];
+            for (uint32 Entry = Grid->BucketStart[Bucket]; Entry < OnePastLast; ++Entry) {
+                if ((Grid->EntryCellX[Entry] != CellX) || (Grid->EntryCellY[Entry] != CellY)) {
+                    continue;
+                }
+
+                real32 dX = Grid->EntryX[Entry] - CenterX;
+                real32 dY = Grid->EntryY[Entry] - CenterY;
+                if ((dX * dX + dY * dY) <= RadiusSq) {
+                    if (ResultCount < MaxResults) {
+                        Results[ResultCount] = Grid->EntryObject[Entry];
+                    }
+                    ++ResultCount;
+                }
+            }
+        }
+    }
+
+    return (ResultCount);
+}
+
+/*
+ * Every unordered pair of objects within Radius of each other, reported once
+ * with A < B. Radius must not exceed the cell size, so only adjacent cells can
+ * hold partners; each entry checks its own cell plus the four "forward"
+ * neighbours, which covers every adjacent cell pair exactly once. Returns the
+ * total pair count; only the first MaxPairs are written.
+ */
+internal uint32
+FindSpatialGridPairs(spatial_grid* Grid, real32 Radius, spatial_pair* Pairs, uint32 MaxPairs) {
+    Assert(Radius <= Grid->CellSize);
+
+    local_persist int32 NeighborOffsets[][2] = {
+            {0, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1},
+    };
+
+    uint32 PairCount = 0;
+    real32 RadiusSq = Radius * Radius;
+
+    for (uint32 Entry = 0; Entry < Grid->Count; ++Entry) {
+        int32 EntryCellX = Grid->EntryCellX[Entry];
+        int32 EntryCellY = Grid->EntryCellY[Entry];
+        real32 EntryX = Grid->EntryX[Entry];
+        real32 EntryY = Grid->EntryY[Entry];
+
+        for (int OffsetIndex = 0; OffsetIndex < ArrayCount(NeighborOffsets); ++OffsetIndex) {
+            int32 CellX = EntryCellX + NeighborOffsets[OffsetIndex][0];
+            int32 CellY = EntryCellY + NeighborOffsets[OffsetIndex][1];
+            uint32 Bucket = SpatialGridBucket(Grid, CellX, CellY);
+
+            uint32 First = Grid->BucketStart[Bucket];
+            if (OffsetIndex == 0) {
+                // NOTE: within our own cell, only pair with the entries after us
+                First = Entry + 1;
+            }
+
+            uint32 OnePastLast = Grid->BucketStart[Bucket + 1];
+            for (uint32 Other = First; Other < OnePastLast; ++Other) {
+                if ((Grid->EntryCellX[Other] != CellX) || (Grid->EntryCellY[Other] != CellY)) {
+                    continue;
+                }
+
+                real32 dX = Grid->EntryX[Other] - EntryX;
+                real32 dY = Grid->EntryY[Other] - EntryY;
+                if ((dX * dX + dY * dY) <= RadiusSq) {
+                    if (PairCount < MaxPairs) {
+                        uint32 A = Grid->EntryObject[Entry];
+                        uint32 B = Grid->EntryObject[Other];
+                        Pairs[PairCount].A = (A < B) ? A : B;
+                        Pairs[PairCount].B = (A < B) ? B : A;
+                    }
+                    ++PairCount;
+                }
+            }
+        }
+    }
+
+    return (PairCount);
+}
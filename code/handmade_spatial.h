@@ -0,0 +1,36 @@
+#if !defined(HANDMADE_SPATIAL_H)
+
+/*
+ * Uniform grid of CellSize squares, hashed into a power-of-two bucket table so
+ * the world does not need fixed bounds. Built from scratch every frame with a
+ * two-pass counting sort: count objects per bucket, prefix-sum into
+ * BucketStart, then scatter. Everything lives in one arena push; there is no
+ * per-cell storage.
+ *
+ * Entries keep their object's position and cell in bucket order, so queries
+ * read contiguous memory and can reject hash collisions by comparing cells.
+ */
+
+struct spatial_grid {
+    real32 CellSize;
+    real32 InvCellSize;
+
+    uint32 BucketMask;
+    uint32 Count;
+
+    uint32* BucketStart; // BucketMask + 2 entries; bucket B is [BucketStart[B], BucketStart[B + 1])
+
+    uint32* EntryObject;
+    real32* EntryX;
+    real32* EntryY;
+    int32* EntryCellX;
+    int32* EntryCellY;
+};
+
+struct spatial_pair {
+    uint32 A;
+    uint32 B;
+};
+
+#define HANDMADE_SPATIAL_H
+#endif
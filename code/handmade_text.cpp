@@ -0,0 +1,243 @@
+
+// NOTE: font8x8_basic by Daniel Hepper (public domain), codepoints 32..126.
+// One byte per row, least significant bit is the leftmost pixel.
+global_variable uint8 GlobalFont8x8[GLYPH_COUNT][8] = {
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // ' '
+        {0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00}, // '!'
+        {0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '"'
+        {0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00}, // '#'
+        {0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00}, // '$'
+        {0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00}, // '%'
+        {0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00}, // '&'
+        {0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00}, // '''
+        {0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00}, // '('
+        {0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00}, // ')'
+        {0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00}, // '*'
+        {0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00}, // '+'
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06}, // ','
+        {0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00}, // '-'
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00}, // '.'
+        {0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00}, // '/'
+        {0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00}, // '0'
+        {0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00}, // '1'
+        {0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00}, // '2'
+        {0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00}, // '3'
+        {0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00}, // '4'
+        {0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00}, // '5'
+        {0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00}, // '6'
+        {0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00}, // '7'
+        {0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00}, // '8'
+        {0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00}, // '9'
+        {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00}, // ':'
+        {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06}, // ';'
+        {0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00}, // '<'
+        {0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00}, // '='
+        {0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00}, // '>'
+        {0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00}, // '?'
+        {0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00}, // '@'
+        {0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00}, // 'A'
+        {0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00}, // 'B'
+        {0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00}, // 'C'
+        {0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00}, // 'D'
+        {0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00}, // 'E'
+        {0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00}, // 'F'
+        {0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00}, // 'G'
+        {0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00}, // 'H'
+        {0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, // 'I'
+        {0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00}, // 'J'
+        {0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00}, // 'K'
+        {0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00}, // 'L'
+        {0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00}, // 'M'
+        {0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00}, // 'N'
+        {0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00}, // 'O'
+        {0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00}, // 'P'
+        {0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00}, // 'Q'
+        {0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00}, // 'R'
+        {0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00}, // 'S'
+        {0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, // 'T'
+        {0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00}, // 'U'
+        {0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00}, // 'V'
+        {0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00}, // 'W'
+        {0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00}, // 'X'
+        {0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00}, // 'Y'
+        {0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00}, // 'Z'
+        {0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00}, // '['
+        {0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00}, // '\'
+        {0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00}, // ']'
+        {0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00}, // '^'
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF}, // '_'
+        {0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00}, // '`'
+        {0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00}, // 'a'
+        {0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00}, // 'b'
+        {0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00}, // 'c'
+        {0x38, 0x30, 0x30, 0x3E, 0x33, 0x33, 0x6E, 0x00}, // 'd'
+        {0x00, 0x00, 0x1E, 0x33, 0x3F, 0x03, 0x1E, 0x00}, // 'e'
+        {0x1C, 0x36, 0x06, 0x0F, 0x06, 0x06, 0x0F, 0x00}, // 'f'
+        {0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F}, // 'g'
+        {0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00}, // 'h'
+        {0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, // 'i'
+        {0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E}, // 'j'
+        {0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00}, // 'k'
+        {0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00}, // 'l'
+        {0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00}, // 'm'
+        {0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00}, // 'n'
+        {0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00}, // 'o'
+        {0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F}, // 'p'
+        {0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78}, // 'q'
+        {0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00}, // 'r'
+        {0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00}, // 's'
+        {0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00}, // 't'
+        {0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00}, // 'u'
+        {0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00}, // 'v'
+        {0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00}, // 'w'
+        {0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00}, // 'x'
+        {0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F}, // 'y'
+        {0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00}, // 'z'
+        {0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00}, // '{'
+        {0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00}, // '|'
+        {0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00}, // '}'
+        {0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '~'
+};
+
+internal void
+InitializeGlyphAtlas(glyph_atlas* Atlas, memory_arena* Arena, int Scale) {
+    Assert(Scale >= 1);
+
+    int GlyphSize = 8 * Scale;
+    int Rows = (GLYPH_COUNT + GLYPH_ATLAS_COLUMNS - 1) / GLYPH_ATLAS_COLUMNS;
+
+    Atlas->Scale = Scale;
+    Atlas->LineAdvance = GlyphSize + Scale;
+    Atlas->Width = GLYPH_ATLAS_COLUMNS * GlyphSize;
+    Atlas->Height = Rows * GlyphSize;
+    Atlas->Pitch = Atlas->Width;
+    Atlas->Masks = PushAlignedArray(Arena, Atlas->Width * Atlas->Height, uint32, 16);
+
+    for (int GlyphIndex = 0; GlyphIndex < GLYPH_COUNT; ++GlyphIndex) {
+        glyph_metrics* Glyph = &Atlas->Glyphs[GlyphIndex];
+        Glyph->AtlasX = (GlyphIndex % GLYPH_ATLAS_COLUMNS) * GlyphSize;
+        Glyph->AtlasY = (GlyphIndex / GLYPH_ATLAS_COLUMNS) * GlyphSize;
+        Glyph->Width = GlyphSize;
+        Glyph->Height = GlyphSize;
+        Glyph->Advance = GlyphSize;
+        Glyph->IsEmpty = true;
+
+        for (int Y = 0; Y < GlyphSize; ++Y) {
+            uint8 Bits = GlobalFont8x8[GlyphIndex][Y / Scale];
+            uint32* Texel = Atlas->Masks + (Glyph->AtlasY + Y) * Atlas->Pitch + Glyph->AtlasX;
+            for (int X = 0; X < GlyphSize; ++X) {
+                bool32 Set = (Bits >> (X / Scale)) & 1;
+                *Texel++ = Set ? 0xFFFFFFFF : 0;
+                if (Set) {
+                    Glyph->IsEmpty = false;
+                }
+            }
+        }
+    }
+}
+
+inline glyph_metrics*
+GetGlyph(glyph_atlas* Atlas, char Codepoint) {
+    int GlyphIndex = (int) Codepoint - GLYPH_FIRST_CODEPOINT;
+    if ((GlyphIndex < 0) || (GlyphIndex >= GLYPH_COUNT)) {
+        GlyphIndex = '?' - GLYPH_FIRST_CODEPOINT;
+    }
+    glyph_metrics* Result = &Atlas->Glyphs[GlyphIndex];
+    return (Result);
+}
+
+internal void
+DrawGlyph(game_offscreen_buffer* Buffer, glyph_atlas* Atlas, glyph_metrics* Glyph,
+          int MinX, int MinY, uint32 Color) {
+    int ClipMinX = (MinX < 0) ? 0 : MinX;
+    int ClipMinY = (MinY < 0) ? 0 : MinY;
+    int ClipMaxX = (MinX + Glyph->Width > Buffer->Width) ? Buffer->Width : (MinX + Glyph->Width);
+    int ClipMaxY = (MinY + Glyph->Height > Buffer->Height) ? Buffer->Height : (MinY + Glyph->Height);
+
+    __m128i Color_4x = _mm_set1_epi32(Color);
+    for (int Y = ClipMinY; Y < ClipMaxY; ++Y) {
+        uint32* Source = Atlas->Masks + (Glyph->AtlasY + Y - MinY) * Atlas->Pitch + Glyph->AtlasX + (ClipMinX - MinX);
+        for (int X = ClipMinX; X < ClipMaxX;) {
+            // NOTE: a whole glyph row unless clipping or a tile edge splits it
+            uint32* Dest = GetPixelPointer(Buffer, X, Y);
+            int SpanEnd = X + GetContiguousSpan(Buffer, X);
+            if (SpanEnd > ClipMaxX) {
+                SpanEnd = ClipMaxX;
+            }
+
+            for (; X + 4 <= SpanEnd; X += 4) {
+                __m128i Mask = _mm_loadu_si128((__m128i*) Source);
+                __m128i Pixels = _mm_loadu_si128((__m128i*) Dest);
+                Pixels = _mm_or_si128(_mm_and_si128(Mask, Color_4x), _mm_andnot_si128(Mask, Pixels));
+                _mm_storeu_si128((__m128i*) Dest, Pixels);
+
+                Source += 4;
+                Dest += 4;
+            }
+            for (; X < SpanEnd; ++X) {
+                if (*Source) {
+                    *Dest = Color;
+                }
+                ++Source;
+                ++Dest;
+            }
+        }
+    }
+}
+
+/*
+ * X, Y is the top left of the first glyph; '\n' starts a new line back at X.
+ */
+internal void
+DrawString(game_offscreen_buffer* Buffer, glyph_atlas* Atlas, int X, int Y, char* String, uint32 Color) {
+    int PenX = X;
+    int PenY = Y;
+    for (char* At = String; *At; ++At) {
+        if (*At == '\n') {
+            PenX = X;
+            PenY += Atlas->LineAdvance;
+            continue;
+        }
+
+        glyph_metrics* Glyph = GetGlyph(Atlas, *At);
+        if (!Glyph->IsEmpty) {
+            DrawGlyph(Buffer, Atlas, Glyph, PenX, PenY, Color);
+        }
+        PenX += Glyph->Advance;
+    }
+}
+
+internal void
+DrawRectangle(game_offscreen_buffer* Buffer, int MinX, int MinY, int MaxX, int MaxY, uint32 Color) {
+    if (MinX < 0) {
+        MinX = 0;
+    }
+    if (MinY < 0) {
+        MinY = 0;
+    }
+    if (MaxX > Buffer->Width) {
+        MaxX = Buffer->Width;
+    }
+    if (MaxY > Buffer->Height) {
+        MaxY = Buffer->Height;
+    }
+
+    __m128i Color_4x = _mm_set1_epi32(Color);
+    for (int Y = MinY; Y < MaxY; ++Y) {
+        for (int X = MinX; X < MaxX;) {
+            uint32* Pixel = GetPixelPointer(Buffer, X, Y);
+            int SpanEnd = X + GetContiguousSpan(Buffer, X);
+            if (SpanEnd > MaxX) {
+                SpanEnd = MaxX;
+            }
+
+            for (; X + 4 <= SpanEnd; X += 4) {
+                _mm_storeu_si128((__m128i*) Pixel, Color_4x);
+                Pixel += 4;
+            }
+            for (; X < SpanEnd; ++X) {
+                *Pixel++ = Color;
+            }
+        }
+    }
+}
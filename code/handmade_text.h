@@ -0,0 +1,36 @@
+#if !defined(HANDMADE_TEXT_H)
+
+/*
+ * Text is drawn from a glyph atlas baked once from an embedded 8x8 bitmap
+ * font. Each atlas texel is a full 32-bit mask (0 or 0xFFFFFFFF), so drawing
+ * a glyph row is a masked select of the text color into the destination, four
+ * pixels at a time.
+ */
+
+#define GLYPH_FIRST_CODEPOINT 32
+#define GLYPH_COUNT 95
+#define GLYPH_ATLAS_COLUMNS 16
+
+struct glyph_metrics {
+    int AtlasX;
+    int AtlasY;
+    int Width;
+    int Height;
+    int Advance;
+    bool32 IsEmpty;
+};
+
+struct glyph_atlas {
+    int Scale;
+    int LineAdvance;
+
+    int Width;
+    int Height;
+    int Pitch; // in pixels, not bytes
+    uint32* Masks;
+
+    glyph_metrics Glyphs[GLYPH_COUNT];
+};
+
+#define HANDMADE_TEXT_H
+#endif
@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include <stddef.h>
 
 #define internal static
 #define local_persist static
@@ -21,20 +22,34 @@ typedef int32 bool32;
 typedef float real32;
 typedef double real64;
 
+typedef size_t memory_index;
+
 // TODO: implement sine ourselves
 #include <math.h>
+// NOTE: the game layer uses SSE2 for its wide kernels, which every x86-64 target has
+#include <x86intrin.h>
 
 #include "handmade.h"
 #include "handmade.cpp"
 
 #include <SDL2/SDL.h>
 #include <stdio.h>
+#include <string.h>
+#include <errno.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
-#include <x86intrin.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <linux/perf_event.h>
+#include <pthread.h>
+#include <semaphore.h>
 
 #include "sdl_handmade.h"
 
@@ -42,7 +57,12 @@ typedef double real64;
 #define MAP_ANONYMOUS MAP_ANON
 #endif
 
-global_variable sdl_offscreen_buffer GlobalBackbuffer;
+// NOTE: Linux 5.14+; older kernels fail it with EINVAL and we touch pages by hand
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+global_variable sdl_present_queue GlobalPresentQueue;
 
 #define MAX_CONTROLLERS 4
 SDL_GameController* ControllerHandles[MAX_CONTROLLERS];
@@ -50,6 +70,23 @@ SDL_Haptic* RumbleHandles[MAX_CONTROLLERS];
 
 sdl_audio_ring_buffer AudioRingBuffer;
 
+global_variable sdl_perf_counters GlobalPerfCounters;
+global_variable platform_job_system GlobalJobSystem;
+global_variable sdl_capture GlobalCapture;
+global_variable platform_file_watcher GlobalFileWatcher;
+global_variable sdl_startup_timing GlobalStartupTiming;
+
+global_variable uint32 GlobalMemoryRegionCount;
+global_variable sdl_memory_region GlobalMemoryRegions[SDL_MAX_MEMORY_REGIONS];
+
+#if HANDMADE_INTERNAL
+global_variable glyph_atlas GlobalDebugFont;
+#endif
+
+/*
+ * Reads into a private copy rather than mapping the file, so a file that is
+ * rewritten or truncated afterwards can't change (or fault) under the caller.
+ */
 internal debug_read_file_result
 DEBUGPlatformReadEntireFile(char* Filename) {
     debug_read_file_result Result = {};
@@ -64,23 +101,55 @@ DEBUGPlatformReadEntireFile(char* Filename) {
         close(FileHandle);
         return Result;
     }
-    Result.ContentsSize = SafeTruncateUInt64(FileStatus.st_size);
+    uint32 FileSize = SafeTruncateUInt64(FileStatus.st_size);
 
-    Result.Contents = mmap(0, Result.ContentsSize, PROT_READ | PROT_WRITE, MAP_PRIVATE,
-                           FileHandle, 0);
-
-    if (Result.Contents == MAP_FAILED) {
-        Result.Contents = 0;
-        Result.ContentsSize = 0;
+    memory_index MappedSize = sizeof(sdl_file_memory_header) + FileSize;
+    void* Memory = mmap(0, MappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (Memory == MAP_FAILED) {
+        close(FileHandle);
+        return Result;
     }
 
+    sdl_file_memory_header* Header = (sdl_file_memory_header*) Memory;
+    uint8* Contents = (uint8*) (Header + 1);
+    uint32 BytesRead = 0;
+    while (BytesRead < FileSize) {
+        ssize_t ReadResult = read(FileHandle, Contents + BytesRead, FileSize - BytesRead);
+        if (ReadResult == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            munmap(Memory, MappedSize);
+            close(FileHandle);
+            return Result;
+        }
+        if (ReadResult == 0) {
+            // NOTE: the file shrank since the fstat; keep what was there
+            break;
+        }
+        BytesRead += (uint32) ReadResult;
+    }
     close(FileHandle);
+
+    Header->MappedSize = MappedSize;
+    Header->ContentsSize = BytesRead;
+    Result.ContentsSize = BytesRead;
+    Result.Contents = Contents;
+    return (Result);
+}
+
+inline sdl_file_memory_header*
+SDLGetFileMemoryHeader(void* Memory) {
+    sdl_file_memory_header* Result = (sdl_file_memory_header*) Memory - 1;
     return (Result);
 }
 
 internal void
 DEBUGPlatformFreeFileMemory(void* Memory) {
-    munmap(Memory, 4096);
+    if (Memory) {
+        sdl_file_memory_header* Header = SDLGetFileMemoryHeader(Memory);
+        munmap(Header, Header->MappedSize);
+    }
 }
 
 internal bool32
@@ -107,6 +176,223 @@ DEBUGPlatformWriteEntireFile(char* Filename, uint32 MemorySize, void* Memory) {
     return true;
 }
 
+internal platform_file_handle
+PlatformOpenFile(char const* Filename) {
+    platform_file_handle Result = {};
+
+    int FileHandle = open(Filename, O_RDONLY);
+    if (FileHandle == -1) {
+        return Result;
+    }
+
+    struct stat FileStatus;
+    if (fstat(FileHandle, &FileStatus) == -1) {
+        close(FileHandle);
+        return Result;
+    }
+
+    Result.NoErrors = true;
+    Result.Size = FileStatus.st_size;
+    Result.Platform = (void*) (intptr_t) FileHandle;
+    return (Result);
+}
+
+internal bool32
+PlatformReadDataFromFile(platform_file_handle* Handle, uint64 Offset, uint64 Size, void* Dest) {
+    if (!Handle->NoErrors) {
+        return false;
+    }
+
+    int FileHandle = (int) (intptr_t) Handle->Platform;
+    uint8* NextByteLocation = (uint8*) Dest;
+    while (Size) {
+        ssize_t BytesRead = pread(FileHandle, NextByteLocation, Size, Offset);
+        if (BytesRead <= 0) {
+            Handle->NoErrors = false;
+            return false;
+        }
+        Size -= BytesRead;
+        Offset += BytesRead;
+        NextByteLocation += BytesRead;
+    }
+
+    return true;
+}
+
+internal void
+PlatformCloseFile(platform_file_handle* Handle) {
+    if (Handle->Platform) {
+        close((int) (intptr_t) Handle->Platform);
+    }
+    *Handle = {};
+}
+
+internal sdl_memory_region*
+SDLFindMemoryRegion(void* Address) {
+    sdl_memory_region* Result = 0;
+    for (uint32 RegionIndex = 0; RegionIndex < GlobalMemoryRegionCount; ++RegionIndex) {
+        sdl_memory_region* Region = &GlobalMemoryRegions[RegionIndex];
+        if (((uint8*) Address >= Region->Base) && ((uint8*) Address < Region->Base + Region->ReservedSize)) {
+            Result = Region;
+            break;
+        }
+    }
+    return (Result);
+}
+
+inline memory_index
+SDLRoundUpToCommit(memory_index Size) {
+    memory_index Result = (Size + SDL_COMMIT_GRANULARITY - 1) & ~(memory_index) (SDL_COMMIT_GRANULARITY - 1);
+    return (Result);
+}
+
+/*
+ * Reserves Size bytes of address space, placed at BaseAddress if the kernel
+ * agrees. Nothing is backed until it is committed.
+ */
+internal sdl_memory_region*
+SDLReserveMemoryRegion(char const* Name, void* BaseAddress, memory_index Size) {
+    sdl_memory_region* Result = 0;
+
+    // NOTE: reuse a released slot before growing the table
+    sdl_memory_region* Slot = 0;
+    for (uint32 RegionIndex = 0; RegionIndex < GlobalMemoryRegionCount; ++RegionIndex) {
+        if (!GlobalMemoryRegions[RegionIndex].Base) {
+            Slot = &GlobalMemoryRegions[RegionIndex];
+            break;
+        }
+    }
+    if (!Slot && (GlobalMemoryRegionCount < SDL_MAX_MEMORY_REGIONS)) {
+        Slot = &GlobalMemoryRegions[GlobalMemoryRegionCount++];
+        *Slot = {};
+    }
+
+    if (Slot) {
+        Size = SDLRoundUpToCommit(Size);
+        void* Base = mmap(BaseAddress, Size, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
+        if (Base != MAP_FAILED) {
+            Result = Slot;
+            *Result = {};
+            Result->Name = Name;
+            Result->Base = (uint8*) Base;
+            Result->ReservedSize = Size;
+        }
+    }
+    return (Result);
+}
+
+/*
+ * Unmaps the whole region. Its slot is left empty for the next reservation,
+ * so pointers to other regions stay valid.
+ */
+internal void
+SDLReleaseMemoryRegion(sdl_memory_region* Region) {
+    if (Region && Region->Base) {
+        munmap(Region->Base, Region->ReservedSize);
+        *Region = {};
+    }
+}
+
+internal bool32
+PlatformCommitMemory(void* Base, memory_index Size) {
+    sdl_memory_region* Region = SDLFindMemoryRegion(Base);
+    if (!Region) {
+        return true;
+    }
+
+    memory_index NewCommittedSize = SDLRoundUpToCommit(((uint8*) Base - Region->Base) + Size);
+    if (NewCommittedSize > Region->ReservedSize) {
+        return false;
+    }
+
+    if (NewCommittedSize > Region->CommittedSize) {
+        if (mprotect(Region->Base + Region->CommittedSize, NewCommittedSize - Region->CommittedSize,
+                     PROT_READ | PROT_WRITE) != 0) {
+            return false;
+        }
+        Region->CommittedSize = NewCommittedSize;
+        if (Region->CommittedHighWater < NewCommittedSize) {
+            Region->CommittedHighWater = NewCommittedSize;
+        }
+        ++Region->CommitCount;
+    }
+
+    return true;
+}
+
+internal void
+PlatformDecommitMemoryAfter(void* Address) {
+    sdl_memory_region* Region = SDLFindMemoryRegion(Address);
+    if (Region) {
+        memory_index KeepSize = SDLRoundUpToCommit((uint8*) Address - Region->Base);
+        if (KeepSize < Region->CommittedSize) {
+            uint8* First = Region->Base + KeepSize;
+            memory_index Size = Region->CommittedSize - KeepSize;
+            // NOTE: DONTNEED drops the pages right away (and zero-fills them if
+            // touched again); PROT_NONE turns any stray use into a fault
+            madvise(First, Size, MADV_DONTNEED);
+            mprotect(First, Size, PROT_NONE);
+            Region->CommittedSize = KeepSize;
+            ++Region->DecommitCount;
+        }
+    }
+}
+
+internal void
+PlatformOutOfMemory(void* Base, memory_index Size) {
+    sdl_memory_region* Region = SDLFindMemoryRegion(Base);
+    fprintf(stderr, "Couldn't commit %llu bytes of %s memory; %llu already committed\n",
+            (unsigned long long) Size, Region ? Region->Name : "game",
+            Region ? (unsigned long long) Region->CommittedSize : 0ULL);
+    abort();
+}
+
+internal void
+SDLUpdateMemoryRegionStats(sdl_memory_region* Region) {
+    memory_index PageSize = (memory_index) sysconf(_SC_PAGESIZE);
+    unsigned char PageFlags[4096];
+    memory_index ResidentPages = 0;
+
+    // NOTE: nothing outside the committed prefix can be resident
+    memory_index PageCount = Region->CommittedSize / PageSize;
+    for (memory_index FirstPage = 0; FirstPage < PageCount; FirstPage += sizeof(PageFlags)) {
+        memory_index BatchCount = PageCount - FirstPage;
+        if (BatchCount > sizeof(PageFlags)) {
+            BatchCount = sizeof(PageFlags);
+        }
+        if (mincore(Region->Base + FirstPage * PageSize, BatchCount * PageSize, PageFlags) == 0) {
+            for (memory_index PageIndex = 0; PageIndex < BatchCount; ++PageIndex) {
+                ResidentPages += PageFlags[PageIndex] & 1;
+            }
+        }
+    }
+
+    Region->ResidentSize = ResidentPages * PageSize;
+    if (Region->ResidentHighWater < Region->ResidentSize) {
+        Region->ResidentHighWater = Region->ResidentSize;
+    }
+}
+
+internal void
+SDLPrintMemoryRegions(FILE* Out) {
+    for (uint32 RegionIndex = 0; RegionIndex < GlobalMemoryRegionCount; ++RegionIndex) {
+        sdl_memory_region* Region = &GlobalMemoryRegions[RegionIndex];
+        if (!Region->Base) {
+            continue;
+        }
+        SDLUpdateMemoryRegionStats(Region);
+        fprintf(Out, "%-10s reserved %lluMB, committed %.02fMB (high %.02fMB), resident %.02fMB (high %.02fMB), "
+               "%u commits, %u decommits\n",
+               Region->Name,
+               (unsigned long long) (Region->ReservedSize / Megabytes(1)),
+               (real64) Region->CommittedSize / (real64) Megabytes(1),
+               (real64) Region->CommittedHighWater / (real64) Megabytes(1),
+               (real64) Region->ResidentSize / (real64) Megabytes(1),
+               (real64) Region->ResidentHighWater / (real64) Megabytes(1),
+               Region->CommitCount, Region->DecommitCount);
+    }
+}
+
 internal void
 SDLAudioCallback(void* UserData, Uint8* AudioData, int Length) {
     sdl_audio_ring_buffer* RingBuffer = (sdl_audio_ring_buffer*) UserData;
@@ -178,38 +464,117 @@ SDLGetSecondsElapsed(uint64 OldCounter, uint64 CurrentCounter) {
     return ((real32) (CurrentCounter - OldCounter) / (real32) (SDL_GetPerformanceFrequency()));
 }
 
+internal game_offscreen_buffer
+SDLGetGameBuffer(sdl_offscreen_buffer* Backbuffer) {
+    game_offscreen_buffer Result = {};
+    Result.Memory = Backbuffer->Memory;
+    Result.Width = Backbuffer->Width;
+    Result.Height = Backbuffer->Height;
+    Result.Pitch = Backbuffer->Pitch;
+    Result.TileShift = Backbuffer->TileShift;
+    return (Result);
+}
+
+/*
+ * (Re)allocates the pixel memory for Width x Height in the buffer's current
+ * TileShift layout.
+ */
 internal void
-SDLResizeTexture(sdl_offscreen_buffer* Buffer, SDL_Renderer* Renderer, int Width, int Height) {
+SDLAllocateBackbuffer(sdl_offscreen_buffer* Buffer, int Width, int Height) {
     int BytesPerPixel = 4;
     if (Buffer->Memory) {
-        munmap(Buffer->Memory, Buffer->Width * Buffer->Height * BytesPerPixel);
-    }
-    if (Buffer->Texture) {
-        SDL_DestroyTexture(Buffer->Texture);
+        munmap(Buffer->Memory, Buffer->MemorySize);
     }
-    Buffer->Texture = SDL_CreateTexture(Renderer,
-                                        SDL_PIXELFORMAT_ARGB8888,
-                                        SDL_TEXTUREACCESS_STREAMING,
-                                        Width,
-                                        Height);
     Buffer->Width = Width;
     Buffer->Height = Height;
-    Buffer->Pitch = Width * BytesPerPixel;
     Buffer->BytesPerPixel = BytesPerPixel;
+
+    // NOTE: a tiled buffer is stored out to whole tiles
+    int TileSize = 1 << Buffer->TileShift;
+    int StoredWidth = ((Width + TileSize - 1) / TileSize) * TileSize;
+    int StoredHeight = ((Height + TileSize - 1) / TileSize) * TileSize;
+    Buffer->Pitch = StoredWidth * BytesPerPixel * TileSize;
+    Buffer->MemorySize = (memory_index) StoredWidth * StoredHeight * BytesPerPixel;
     Buffer->Memory = mmap(0,
-                          Width * Height * BytesPerPixel,
+                          Buffer->MemorySize,
                           PROT_READ | PROT_WRITE,
                           MAP_PRIVATE | MAP_ANONYMOUS,
                           -1,
                           0);
 }
 
+internal void
+SDLResizeTexture(sdl_offscreen_buffer* Buffer, SDL_Renderer* Renderer, int Width, int Height) {
+    if (Buffer->Texture) {
+        SDL_DestroyTexture(Buffer->Texture);
+    }
+    Buffer->Texture = SDL_CreateTexture(Renderer,
+                                        SDL_PIXELFORMAT_ARGB8888,
+                                        SDL_TEXTUREACCESS_STREAMING,
+                                        Width,
+                                        Height);
+    SDLAllocateBackbuffer(Buffer, Width, Height);
+}
+
+/*
+ * Copies the backbuffer into Dest in plain row order, undoing the tiling if
+ * there is any. Each tile row is one or more 16-byte chunks, so tiles that
+ * are fully on screen go through SSE loads straight from the tile.
+ */
+internal void
+SDLCopyBackbufferLinear(sdl_offscreen_buffer* Buffer, void* Dest, int DestPitch) {
+    int RowSize = Buffer->Width * Buffer->BytesPerPixel;
+    if (!Buffer->TileShift) {
+        uint8* SourceRow = (uint8*) Buffer->Memory;
+        uint8* DestRow = (uint8*) Dest;
+        for (int Y = 0; Y < Buffer->Height; ++Y) {
+            memcpy(DestRow, SourceRow, RowSize);
+            SourceRow += Buffer->Pitch;
+            DestRow += DestPitch;
+        }
+        return;
+    }
+
+    int Shift = Buffer->TileShift;
+    int TileSize = 1 << Shift;
+    int TileBytes = 4 << (2 * Shift);
+    int WholeTileCount = Buffer->Width >> Shift;
+    int EdgeWidth = Buffer->Width & (TileSize - 1);
+
+    uint8* DestRow = (uint8*) Dest;
+    for (int Y = 0; Y < Buffer->Height; ++Y) {
+        // NOTE: row Y & (TileSize - 1) of every tile in tile row Y >> Shift
+        uint8* Source = (uint8*) Buffer->Memory + (Y >> Shift) * Buffer->Pitch + ((Y & (TileSize - 1)) << Shift) * 4;
+        __m128i* Out = (__m128i*) DestRow;
+        for (int TileX = 0; TileX < WholeTileCount; ++TileX) {
+            __m128i* In = (__m128i*) Source;
+            for (int Chunk = 0; Chunk < (TileSize / 4); ++Chunk) {
+                _mm_storeu_si128(Out++, _mm_load_si128(In++));
+            }
+            Source += TileBytes;
+        }
+        if (EdgeWidth) {
+            memcpy(Out, Source, EdgeWidth * 4);
+        }
+        DestRow += DestPitch;
+    }
+}
+
 internal void
 SDLUpdateWindow(SDL_Window* Window, SDL_Renderer* Renderer, sdl_offscreen_buffer* Buffer) {
-    SDL_UpdateTexture(Buffer->Texture,
-                      0,
-                      Buffer->Memory,
-                      Buffer->Pitch);
+    if (Buffer->TileShift) {
+        void* TexturePixels;
+        int TexturePitch;
+        if (SDL_LockTexture(Buffer->Texture, 0, &TexturePixels, &TexturePitch) == 0) {
+            SDLCopyBackbufferLinear(Buffer, TexturePixels, TexturePitch);
+            SDL_UnlockTexture(Buffer->Texture);
+        }
+    } else {
+        SDL_UpdateTexture(Buffer->Texture,
+                          0,
+                          Buffer->Memory,
+                          Buffer->Pitch);
+    }
 
     SDL_RenderCopy(Renderer,
                    Buffer->Texture,
@@ -219,6 +584,252 @@ SDLUpdateWindow(SDL_Window* Window, SDL_Renderer* Renderer, sdl_offscreen_buffer
     SDL_RenderPresent(Renderer);
 }
 
+//
+// Presenting
+//
+
+/*
+ * Creates the renderer and gives every buffer its pixel memory. Uploads only
+ * ever happen one at a time on the presenting thread, so the buffers share
+ * one streaming texture.
+ */
+internal bool32
+SDLCreatePresentRenderer(sdl_present_queue* Queue) {
+    int Width;
+    int Height;
+    if (Queue->Surface) {
+        Queue->Renderer = SDL_CreateSoftwareRenderer(Queue->Surface);
+        Width = Queue->Surface->w;
+        Height = Queue->Surface->h;
+    } else {
+        Queue->Renderer = SDL_CreateRenderer(Queue->Window, -1, SDL_RENDERER_PRESENTVSYNC);
+        sdl_window_dimension Dimension = SDLGetWindowDimension(Queue->Window);
+        Width = Dimension.Width;
+        Height = Dimension.Height;
+    }
+    if (!Queue->Renderer) {
+        return false;
+    }
+
+    SDLResizeTexture(&Queue->Buffers[0], Queue->Renderer, Width, Height);
+    for (uint32 BufferIndex = 1; BufferIndex < Queue->BufferCount; ++BufferIndex) {
+        sdl_offscreen_buffer* Buffer = &Queue->Buffers[BufferIndex];
+        Buffer->Texture = Queue->Buffers[0].Texture;
+        SDLAllocateBackbuffer(Buffer, Width, Height);
+    }
+
+    return true;
+}
+
+internal void
+SDLDestroyPresentRenderer(sdl_present_queue* Queue) {
+    if (Queue->Buffers[0].Texture) {
+        SDL_DestroyTexture(Queue->Buffers[0].Texture);
+    }
+    SDL_DestroyRenderer(Queue->Renderer);
+}
+
+internal void
+SDLPresentQueuedBuffer(sdl_present_queue* Queue, uint32 PresentIndex) {
+    uint32 BufferIndex = PresentIndex % Queue->BufferCount;
+    uint64 Start = SDL_GetPerformanceCounter();
+    SDLUpdateWindow(Queue->Window, Queue->Renderer, &Queue->Buffers[BufferIndex]);
+    uint64 End = SDL_GetPerformanceCounter();
+
+    // NOTE: only this thread writes the totals; the overlay reads them while it runs
+    uint64 Latency = End - Queue->SubmittedAt[BufferIndex];
+    Queue->Latencies[PresentIndex % SDL_PRESENT_LATENCY_HISTORY] = Latency;
+    __atomic_store_n(&Queue->LatencyTotal, Queue->LatencyTotal + Latency, __ATOMIC_RELAXED);
+    if (Latency > Queue->LatencyMax) {
+        __atomic_store_n(&Queue->LatencyMax, Latency, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&Queue->PresentTotal, Queue->PresentTotal + (End - Start), __ATOMIC_RELAXED);
+    Queue->LastPresentedAt = End;
+}
+
+internal void*
+SDLPresentThreadProc(void* Parameter) {
+    sdl_present_queue* Queue = (sdl_present_queue*) Parameter;
+
+    // NOTE: an SDL renderer belongs to the thread that created it
+    bool32 Ready = SDLCreatePresentRenderer(Queue);
+    sem_post(&Queue->ReadySemaphore);
+    if (!Ready) {
+        return 0;
+    }
+
+    // NOTE: one post per submitted frame, and one more to quit once they're all up
+    uint32 PresentCount = Queue->PresentCount;
+    for (;;) {
+        sem_wait(&Queue->FilledSemaphore);
+        if (PresentCount != __atomic_load_n(&Queue->SubmitCount, __ATOMIC_ACQUIRE)) {
+            SDLPresentQueuedBuffer(Queue, PresentCount);
+            ++PresentCount;
+            __atomic_store_n(&Queue->PresentCount, PresentCount, __ATOMIC_RELEASE);
+            sem_post(&Queue->FreeSemaphore);
+        } else if (__atomic_load_n(&Queue->Quit, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+    }
+
+    SDLDestroyPresentRenderer(Queue);
+    return 0;
+}
+
+/*
+ * Presents to Window, or to Surface through a software renderer if Window is
+ * null. With BufferCount of 2 or 3 presenting moves to its own thread; with 1
+ * (or if the thread can't have the renderer) it stays inline on this one.
+ *
+ * SDL only supports its render API on the main thread. A renderer created on
+ * the present thread is fine with the software renderer the bench uses, but
+ * SDL makes no promise for the others, so threaded presenting is something
+ * to ask for rather than the default.
+ */
+internal bool32
+SDLInitPresentQueue(sdl_present_queue* Queue, SDL_Window* Window, SDL_Surface* Surface,
+                    uint32 BufferCount, int TileShift) {
+    *Queue = {};
+    Queue->Window = Window;
+    Queue->Surface = Surface;
+    Queue->BufferCount = BufferCount;
+    if (Queue->BufferCount < 1) {
+        Queue->BufferCount = 1;
+    } else if (Queue->BufferCount > SDL_MAX_PRESENT_BUFFERS) {
+        Queue->BufferCount = SDL_MAX_PRESENT_BUFFERS;
+    }
+    for (int BufferIndex = 0; BufferIndex < SDL_MAX_PRESENT_BUFFERS; ++BufferIndex) {
+        Queue->Buffers[BufferIndex].TileShift = TileShift;
+    }
+
+    if (Queue->BufferCount > 1) {
+        sem_init(&Queue->ReadySemaphore, 0, 0);
+        sem_init(&Queue->FilledSemaphore, 0, 0);
+        sem_init(&Queue->FreeSemaphore, 0, Queue->BufferCount);
+        if (pthread_create(&Queue->Thread, 0, SDLPresentThreadProc, Queue) == 0) {
+            sem_wait(&Queue->ReadySemaphore);
+            if (Queue->Renderer) {
+                Queue->Threaded = true;
+            } else {
+                pthread_join(Queue->Thread, 0);
+            }
+        }
+        if (!Queue->Threaded) {
+            sem_destroy(&Queue->ReadySemaphore);
+            sem_destroy(&Queue->FilledSemaphore);
+            sem_destroy(&Queue->FreeSemaphore);
+        }
+    }
+
+    bool32 Result = Queue->Threaded;
+    if (!Result) {
+        // NOTE: some drivers only give out renderers on the main thread
+        Queue->BufferCount = 1;
+        Result = SDLCreatePresentRenderer(Queue);
+    }
+
+    return (Result);
+}
+
+/*
+ * The buffer the next frame goes into. Threaded, this is the fence on the
+ * presenting side: it waits until the present thread has let go of the
+ * buffer, which only happens if presenting has fallen BufferCount - 1 frames
+ * behind. Call exactly once per SDLSubmitBackbuffer.
+ */
+internal sdl_offscreen_buffer*
+SDLAcquireBackbuffer(sdl_present_queue* Queue) {
+    if (Queue->Threaded) {
+        uint64 Start = SDL_GetPerformanceCounter();
+        sem_wait(&Queue->FreeSemaphore);
+        Queue->FenceWaitTotal += SDL_GetPerformanceCounter() - Start;
+    }
+
+    sdl_offscreen_buffer* Result = &Queue->Buffers[Queue->SubmitCount % Queue->BufferCount];
+    return (Result);
+}
+
+// NOTE: threaded, returns as soon as the present thread has been told
+internal void
+SDLSubmitBackbuffer(sdl_present_queue* Queue) {
+    uint32 SubmitCount = Queue->SubmitCount;
+    Queue->SubmittedAt[SubmitCount % Queue->BufferCount] = SDL_GetPerformanceCounter();
+    if (Queue->Threaded) {
+        __atomic_store_n(&Queue->SubmitCount, SubmitCount + 1, __ATOMIC_RELEASE);
+        sem_post(&Queue->FilledSemaphore);
+    } else {
+        SDLPresentQueuedBuffer(Queue, SubmitCount);
+        Queue->SubmitCount = SubmitCount + 1;
+        Queue->PresentCount = SubmitCount + 1;
+    }
+}
+
+// NOTE: waits until everything submitted is on screen
+internal void
+SDLFlushPresentQueue(sdl_present_queue* Queue) {
+    if (Queue->Threaded) {
+        for (uint32 BufferIndex = 0; BufferIndex < Queue->BufferCount; ++BufferIndex) {
+            sem_wait(&Queue->FreeSemaphore);
+        }
+        for (uint32 BufferIndex = 0; BufferIndex < Queue->BufferCount; ++BufferIndex) {
+            sem_post(&Queue->FreeSemaphore);
+        }
+    }
+}
+
+// NOTE: threaded, the renderer isn't ours to use and the next frame is due shortly anyway
+internal void
+SDLRepresentBackbuffer(sdl_present_queue* Queue) {
+    if (!Queue->Threaded && Queue->Renderer && Queue->PresentCount) {
+        SDLUpdateWindow(Queue->Window, Queue->Renderer, &Queue->Buffers[0]);
+    }
+}
+
+/*
+ * Queued is how long frames waited for the present thread on top of the
+ * upload and present themselves; that's the latency the pipeline adds.
+ * Threaded, call it after SDLFlushPresentQueue so the totals hold still.
+ */
+internal void
+SDLPrintPresentStats(sdl_present_queue* Queue, FILE* Out) {
+    uint32 Count = Queue->PresentCount;
+    if (!Count) {
+        return;
+    }
+
+    real64 MSPerCount = 1000.0 / (real64) SDL_GetPerformanceFrequency();
+    fprintf(Out, "Presented %u frames %s with %u buffers: present %.02fms, queued %.02fms, "
+                 "submit to screen %.02fms (max %.02fms), render waited %.02fms per frame\n",
+            Count, Queue->Threaded ? "from a thread" : "inline", Queue->BufferCount,
+            (real64) Queue->PresentTotal * MSPerCount / (real64) Count,
+            (real64) (Queue->LatencyTotal - Queue->PresentTotal) * MSPerCount / (real64) Count,
+            (real64) Queue->LatencyTotal * MSPerCount / (real64) Count,
+            (real64) Queue->LatencyMax * MSPerCount,
+            (real64) Queue->FenceWaitTotal * MSPerCount / (real64) Count);
+}
+
+internal void
+SDLShutdownPresentQueue(sdl_present_queue* Queue) {
+    if (Queue->Threaded) {
+        __atomic_store_n(&Queue->Quit, true, __ATOMIC_RELEASE);
+        sem_post(&Queue->FilledSemaphore);
+        pthread_join(Queue->Thread, 0);
+        sem_destroy(&Queue->ReadySemaphore);
+        sem_destroy(&Queue->FilledSemaphore);
+        sem_destroy(&Queue->FreeSemaphore);
+    } else if (Queue->Renderer) {
+        SDLDestroyPresentRenderer(Queue);
+    }
+
+    for (uint32 BufferIndex = 0; BufferIndex < Queue->BufferCount; ++BufferIndex) {
+        sdl_offscreen_buffer* Buffer = &Queue->Buffers[BufferIndex];
+        if (Buffer->Memory) {
+            munmap(Buffer->Memory, Buffer->MemorySize);
+        }
+    }
+    *Queue = {};
+}
+
 internal void
 SDLProcessKeyPress(game_button_state* NewState, bool32 IsDown) {
     Assert(NewState->EndedDown != IsDown);
@@ -298,9 +909,7 @@ bool HandleEvent(SDL_Event* Event, game_controller_input* NewKeyboardController)
                     break;
 
                 case SDL_WINDOWEVENT_EXPOSED: {
-                    SDL_Window* Window = SDL_GetWindowFromID(Event->window.windowID);
-                    SDL_Renderer* Renderer = SDL_GetRenderer(Window);
-                    SDLUpdateWindow(Window, Renderer, &GlobalBackbuffer);
+                    SDLRepresentBackbuffer(&GlobalPresentQueue);
                 }
                     break;
             }
@@ -400,13 +1009,10 @@ internal void
 SDLDebugDrawVertical(sdl_offscreen_buffer *GlobalBackBuffer,
                      int X, int Top, int Bottom, uint32 Color)
 {
-    uint8 *Pixel = ((uint8 *)GlobalBackBuffer->Memory +
-            X*GlobalBackBuffer->BytesPerPixel +
-            Top*GlobalBackBuffer->Pitch);
+    game_offscreen_buffer Buffer = SDLGetGameBuffer(GlobalBackBuffer);
     for(int Y = Top; Y < Bottom; ++Y)
     {
-        *(uint32 *)Pixel = Color;
-        Pixel += GlobalBackBuffer->Pitch;
+        *GetPixelPointer(&Buffer, X, Y) = Color;
     }
 }
 
@@ -442,76 +1048,1260 @@ SDLDebugSyncDisplay(sdl_offscreen_buffer *Backbuffer,
     }
 }
 
-// ENTER HERE
-int main(int argc, char* argv[]) {
-    SDL_Init(SDL_INIT_VIDEO | SDL_INIT_GAMECONTROLLER | SDL_INIT_HAPTIC | SDL_INIT_AUDIO);
-    uint64 PerfCountFrequency = SDL_GetPerformanceFrequency();
+#if HANDMADE_INTERNAL
+internal void
+SDLInitDebugOverlay() {
+    memory_index FontMemorySize = Kilobytes(256);
+    void* FontMemory = mmap(0, FontMemorySize,
+                            PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS,
+                            -1, 0);
+    Assert(FontMemory != MAP_FAILED);
+
+    memory_arena FontArena;
+    InitializeArena(&FontArena, FontMemorySize, FontMemory);
+    InitializeGlyphAtlas(&GlobalDebugFont, &FontArena, 2);
+}
 
-    // Initialize game controllers:
-    SDLOpenGameControllers();
-    // create the window
-    SDL_Window* Window = SDL_CreateWindow("Handmade Hero",
-                                          SDL_WINDOWPOS_UNDEFINED,
-                                          SDL_WINDOWPOS_UNDEFINED,
-                                          640,
-                                          480,
-                                          SDL_WINDOW_RESIZABLE);
+internal void
+SDLDebugDrawOverlay(sdl_offscreen_buffer* Backbuffer, sdl_sound_output* SoundOutput, game_memory* Memory,
+                    real64 MSPerFrame, real64 FPS, real64 MCPF) {
+    game_offscreen_buffer Buffer = SDLGetGameBuffer(Backbuffer);
+
+    struct rusage Usage = {};
+    getrusage(RUSAGE_SELF, &Usage);
+
+    char Text[1024];
+    int TextLength = snprintf(Text, sizeof(Text),
+                              "%.02fms/f %.02ff/s %.02fMc/f\n"
+                              "audio play %d write %d / %d\n"
+                              "process rss peak %ldMB",
+                              MSPerFrame, FPS, MCPF,
+                              AudioRingBuffer.PlayCursor, AudioRingBuffer.WriteCursor,
+                              SoundOutput->SecondaryBufferSize,
+                              Usage.ru_maxrss / 1024);
+    if (GlobalCapture.Enabled && (TextLength >= 0) && (TextLength < (int) sizeof(Text))) {
+        TextLength += snprintf(Text + TextLength, sizeof(Text) - TextLength,
+                               "\ncapture %llu written %llu dropped",
+                               (unsigned long long) GlobalCapture.FramesWritten,
+                               (unsigned long long) GlobalCapture.FramesDropped);
+    }
+    if (GlobalStartupTiming.FirstFramePresented && (TextLength >= 0) && (TextLength < (int) sizeof(Text))) {
+        TextLength += snprintf(Text + TextLength, sizeof(Text) - TextLength,
+                               "\nfirst frame after %.02fms",
+                               (real64) (GlobalStartupTiming.FirstFramePresented - GlobalStartupTiming.MainEntered) *
+                               1000.0 / (real64) SDL_GetPerformanceFrequency());
+    }
+    // NOTE: the present thread keeps adding to these; being a frame off doesn't matter here
+    uint32 PresentCount = __atomic_load_n(&GlobalPresentQueue.PresentCount, __ATOMIC_ACQUIRE);
+    uint64 PresentTotal = __atomic_load_n(&GlobalPresentQueue.PresentTotal, __ATOMIC_RELAXED);
+    uint64 LatencyTotal = __atomic_load_n(&GlobalPresentQueue.LatencyTotal, __ATOMIC_RELAXED);
+    if (PresentCount && (TextLength >= 0) && (TextLength < (int) sizeof(Text))) {
+        real64 MSPerCount = 1000.0 / (real64) SDL_GetPerformanceFrequency();
+        TextLength += snprintf(Text + TextLength, sizeof(Text) - TextLength,
+                               "\npresent %.02fms queued %.02fms, %u buffers",
+                               (real64) PresentTotal * MSPerCount / (real64) PresentCount,
+                               (real64) (LatencyTotal - PresentTotal) * MSPerCount / (real64) PresentCount,
+                               GlobalPresentQueue.BufferCount);
+    }
+    if (GlobalFileWatcher.FileCount && (TextLength >= 0) && (TextLength < (int) sizeof(Text))) {
+        TextLength += snprintf(Text + TextLength, sizeof(Text) - TextLength,
+                               "\nwatching %u files, %u reloads %u failed",
+                               GlobalFileWatcher.FileCount, GlobalFileWatcher.ReloadCount,
+                               GlobalFileWatcher.FailedReadCount);
+    }
+    for (uint32 RegionIndex = 0; RegionIndex < GlobalMemoryRegionCount; ++RegionIndex) {
+        sdl_memory_region* Region = &GlobalMemoryRegions[RegionIndex];
+        if (!Region->Base) {
+            continue;
+        }
+        SDLUpdateMemoryRegionStats(Region);
+        if ((TextLength >= 0) && (TextLength < (int) sizeof(Text))) {
+            TextLength += snprintf(Text + TextLength, sizeof(Text) - TextLength,
+                                   "\n%s commit %.01f/%lluMB hw %.01f rss %.01f hw %.01f",
+                                   Region->Name,
+                                   (real64) Region->CommittedSize / (real64) Megabytes(1),
+                                   (unsigned long long) (Region->ReservedSize / Megabytes(1)),
+                                   (real64) Region->CommittedHighWater / (real64) Megabytes(1),
+                                   (real64) Region->ResidentSize / (real64) Megabytes(1),
+                                   (real64) Region->ResidentHighWater / (real64) Megabytes(1));
+        }
+    }
 
-    if (Window) {
-        // create a renderer for the window
-        SDL_Renderer* Renderer = SDL_CreateRenderer(Window, -1, SDL_RENDERER_PRESENTVSYNC);
+    int LineCount = 1;
+    int LongestLine = 0;
+    int LineLength = 0;
+    for (char* At = Text; *At; ++At) {
+        if (*At == '\n') {
+            ++LineCount;
+            LineLength = 0;
+        } else if (++LineLength > LongestLine) {
+            LongestLine = LineLength;
+        }
+    }
 
-        printf("Refresh rate is %d Hz\n", SDLGetWindowRefreshRate(Window));
-        int GameUpdateHz = 30;
+    int PadX = 16;
+    int PadY = 16;
+    int GlyphSize = 8 * GlobalDebugFont.Scale;
+    DrawRectangle(&Buffer, PadX, PadY,
+                  PadX + LongestLine * GlyphSize + 2 * GlobalDebugFont.Scale,
+                  PadY + LineCount * GlobalDebugFont.LineAdvance + GlobalDebugFont.Scale,
+                  0xFF000000);
+    DrawString(&Buffer, &GlobalDebugFont, PadX + GlobalDebugFont.Scale, PadY + GlobalDebugFont.Scale,
+               Text, 0xFFFFFFFF);
+}
+#endif
+
+internal int
+SDLOpenPerfCounter(uint32 Type, uint64 Config, int GroupFd) {
+    struct perf_event_attr Attr = {};
+    Attr.size = sizeof(Attr);
+    Attr.type = Type;
+    Attr.config = Config;
+    Attr.disabled = (GroupFd == -1) ? 1 : 0;
+    // NOTE: user space only, so this works at the default perf_event_paranoid
+    Attr.exclude_kernel = 1;
+    Attr.exclude_hv = 1;
+    Attr.read_format = PERF_FORMAT_GROUP;
+
+    int Result = (int) syscall(SYS_perf_event_open, &Attr, 0, -1, GroupFd, 0);
+    return (Result);
+}
+
+internal void
+SDLInitPerfCounters(sdl_perf_counters* Counters) {
+    struct {
+        uint32 Type;
+        uint64 Config;
+    } Events[PerfCounter_Count] = {};
+    Events[PerfCounter_Cycles] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+    Events[PerfCounter_Instructions] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS};
+    Events[PerfCounter_CacheMisses] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES};
+    Events[PerfCounter_BranchMisses] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES};
+    Events[PerfCounter_PageFaults] = {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS};
+
+    Counters->GroupFd = -1;
+    Counters->OpenCount = 0;
+    for (int CounterIndex = 0; CounterIndex < PerfCounter_Count; ++CounterIndex) {
+        int Fd = SDLOpenPerfCounter(Events[CounterIndex].Type, Events[CounterIndex].Config, Counters->GroupFd);
+        Counters->Fds[CounterIndex] = Fd;
+        Counters->ReadSlot[CounterIndex] = -1;
+        if (Fd != -1) {
+            if (Counters->GroupFd == -1) {
+                Counters->GroupFd = Fd;
+            }
+            Counters->ReadSlot[CounterIndex] = Counters->OpenCount++;
+        } else {
+            fprintf(stderr, "perf_event_open failed for counter %d: %s\n", CounterIndex, strerror(errno));
+        }
+    }
+
+    if (Counters->GroupFd != -1) {
+        ioctl(Counters->GroupFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(Counters->GroupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        Counters->Enabled = true;
+    }
+}
+
+internal void
+SDLClosePerfCounters(sdl_perf_counters* Counters) {
+    for (int CounterIndex = 0; CounterIndex < PerfCounter_Count; ++CounterIndex) {
+        if (Counters->Fds[CounterIndex] != -1) {
+            close(Counters->Fds[CounterIndex]);
+            Counters->Fds[CounterIndex] = -1;
+        }
+    }
+    Counters->GroupFd = -1;
+    Counters->Enabled = false;
+}
+
+internal void
+SDLReadPerfCounters(sdl_perf_counters* Counters, uint64* Values) {
+    uint64 ReadBuffer[1 + PerfCounter_Count] = {};
+    ssize_t BytesRead = read(Counters->GroupFd, ReadBuffer, sizeof(ReadBuffer));
+
+    for (int CounterIndex = 0; CounterIndex < PerfCounter_Count; ++CounterIndex) {
+        int Slot = Counters->ReadSlot[CounterIndex];
+        if ((BytesRead > 0) && (Slot != -1) && ((uint64) Slot < ReadBuffer[0])) {
+            Values[CounterIndex] = ReadBuffer[1 + Slot];
+        } else {
+            Values[CounterIndex] = 0;
+        }
+    }
+}
+
+inline void
+SDLPerfBeginPhase(sdl_perf_counters* Counters) {
+    if (Counters->Enabled) {
+        SDLReadPerfCounters(Counters, Counters->PhaseStart);
+    }
+}
+
+inline void
+SDLPerfEndPhase(sdl_perf_counters* Counters, sdl_perf_phase Phase) {
+    if (Counters->Enabled) {
+        uint64 PhaseEnd[PerfCounter_Count];
+        SDLReadPerfCounters(Counters, PhaseEnd);
+        for (int CounterIndex = 0; CounterIndex < PerfCounter_Count; ++CounterIndex) {
+            Counters->Current.Values[Phase][CounterIndex] += PhaseEnd[CounterIndex] - Counters->PhaseStart[CounterIndex];
+        }
+    }
+}
+
+internal void
+SDLPerfEndFrame(sdl_perf_counters* Counters) {
+    if (Counters->Enabled) {
+        Counters->Current.FrameIndex = Counters->FrameIndex;
+        Counters->Records[Counters->NextRecord] = Counters->Current;
+        Counters->NextRecord = (Counters->NextRecord + 1) % PERF_FRAME_RECORD_COUNT;
+        if (Counters->RecordCount < PERF_FRAME_RECORD_COUNT) {
+            ++Counters->RecordCount;
+        }
+        Counters->Current = {};
+    }
+    ++Counters->FrameIndex;
+}
+
+/*
+ * Writes every frame still in the ring to Filename as CSV and prints the
+ * per-phase averages (with IPC and misses per thousand instructions).
+ */
+internal void
+SDLDumpPerfCounters(sdl_perf_counters* Counters, char const* Filename) {
+    if (Counters->RecordCount == 0) {
+        return;
+    }
+
+    char const* PhaseNames[PerfPhase_Count] = {"game", "sound", "present"};
+
+    FILE* File = fopen(Filename, "w");
+    if (File) {
+        fprintf(File, "frame,phase,cycles,instructions,cache_misses,branch_misses,page_faults\n");
+    }
+
+    uint64 Totals[PerfPhase_Count][PerfCounter_Count] = {};
+    uint32 FirstRecord = (Counters->NextRecord + PERF_FRAME_RECORD_COUNT - Counters->RecordCount) %
+                         PERF_FRAME_RECORD_COUNT;
+    for (uint32 RecordIndex = 0; RecordIndex < Counters->RecordCount; ++RecordIndex) {
+        sdl_perf_frame_record* Record = &Counters->Records[(FirstRecord + RecordIndex) % PERF_FRAME_RECORD_COUNT];
+        for (int Phase = 0; Phase < PerfPhase_Count; ++Phase) {
+            uint64* Values = Record->Values[Phase];
+            if (File) {
+                fprintf(File, "%llu,%s,%llu,%llu,%llu,%llu,%llu\n",
+                        (unsigned long long) Record->FrameIndex, PhaseNames[Phase],
+                        (unsigned long long) Values[PerfCounter_Cycles],
+                        (unsigned long long) Values[PerfCounter_Instructions],
+                        (unsigned long long) Values[PerfCounter_CacheMisses],
+                        (unsigned long long) Values[PerfCounter_BranchMisses],
+                        (unsigned long long) Values[PerfCounter_PageFaults]);
+            }
+            for (int CounterIndex = 0; CounterIndex < PerfCounter_Count; ++CounterIndex) {
+                Totals[Phase][CounterIndex] += Values[CounterIndex];
+            }
+        }
+    }
+
+    if (File) {
+        fclose(File);
+        printf("Wrote %u frames of perf counters to %s\n", Counters->RecordCount, Filename);
+    }
+
+    real64 FrameCount = (real64) Counters->RecordCount;
+    for (int Phase = 0; Phase < PerfPhase_Count; ++Phase) {
+        uint64* Total = Totals[Phase];
+        real64 Instructions = (real64) Total[PerfCounter_Instructions];
+        real64 IPC = Total[PerfCounter_Cycles] ? Instructions / (real64) Total[PerfCounter_Cycles] : 0.0;
+        real64 KiloInstructions = (Instructions > 0.0) ? (Instructions / 1000.0) : 1.0;
+        printf("%-8s %.02f Mcycles/f, %.02f Minstr/f, IPC %.02f, cache miss %.02f/Kinstr, "
+               "branch miss %.02f/Kinstr, %.01f faults/f\n",
+               PhaseNames[Phase],
+               (real64) Total[PerfCounter_Cycles] / FrameCount / (1000.0 * 1000.0),
+               Instructions / FrameCount / (1000.0 * 1000.0),
+               IPC,
+               (real64) Total[PerfCounter_CacheMisses] / KiloInstructions,
+               (real64) Total[PerfCounter_BranchMisses] / KiloInstructions,
+               (real64) Total[PerfCounter_PageFaults] / FrameCount);
+    }
+}
+
+//
+// Job system
+//
+
+// NOTE: index of the calling thread's sdl_worker; the thread that set up the
+// job system keeps the default of 0.
+global_variable __thread uint32 GlobalWorkerIndex;
+
+internal bool32
+SDLPushJob(sdl_job_deque* Deque, sdl_job Job) {
+    bool32 Result = false;
+
+    int64 Bottom = __atomic_load_n(&Deque->Bottom, __ATOMIC_RELAXED);
+    int64 Top = __atomic_load_n(&Deque->Top, __ATOMIC_ACQUIRE);
+    if ((Bottom - Top) < JOB_DEQUE_CAPACITY) {
+        Deque->Jobs[Bottom & (JOB_DEQUE_CAPACITY - 1)] = Job;
+        __atomic_store_n(&Deque->Bottom, Bottom + 1, __ATOMIC_RELEASE);
+        Result = true;
+    }
+
+    return (Result);
+}
+
+internal bool32
+SDLPopJob(sdl_job_deque* Deque, sdl_job* Job) {
+    bool32 Result = false;
+
+    int64 Bottom = __atomic_load_n(&Deque->Bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&Deque->Bottom, Bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64 Top = __atomic_load_n(&Deque->Top, __ATOMIC_RELAXED);
+
+    if (Top <= Bottom) {
+        *Job = Deque->Jobs[Bottom & (JOB_DEQUE_CAPACITY - 1)];
+        Result = true;
+        if (Top == Bottom) {
+            // NOTE: last job; race the thieves for it through Top
+            if (!__atomic_compare_exchange_n(&Deque->Top, &Top, Top + 1, false,
+                                             __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+                Result = false;
+            }
+            __atomic_store_n(&Deque->Bottom, Bottom + 1, __ATOMIC_RELAXED);
+        }
+    } else {
+        __atomic_store_n(&Deque->Bottom, Bottom + 1, __ATOMIC_RELAXED);
+    }
+
+    return (Result);
+}
+
+internal bool32
+SDLStealJob(sdl_job_deque* Deque, sdl_job* Job) {
+    bool32 Result = false;
+
+    int64 Top = __atomic_load_n(&Deque->Top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64 Bottom = __atomic_load_n(&Deque->Bottom, __ATOMIC_ACQUIRE);
+
+    if (Top < Bottom) {
+        *Job = Deque->Jobs[Top & (JOB_DEQUE_CAPACITY - 1)];
+        if (__atomic_compare_exchange_n(&Deque->Top, &Top, Top + 1, false,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            Result = true;
+        }
+    }
+
+    return (Result);
+}
+
+internal void
+SDLExecuteJob(sdl_worker* Worker, sdl_job* Job) {
+    // NOTE: a job run from inside another job's wait stacks on top of its scratch
+    temporary_memory JobMemory = BeginTemporaryMemory(&Worker->Scratch);
+    Job->Callback(Worker->JobSystem, Job->Data);
+    EndTemporaryMemory(JobMemory);
+    __atomic_sub_fetch(&Job->Group->PendingCount, 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Runs one job: the worker's own newest job if it has one, otherwise the
+ * oldest job of some other worker, starting from a random victim.
+ */
+internal bool32
+SDLRunNextJob(sdl_worker* Worker) {
+    platform_job_system* JobSystem = Worker->JobSystem;
+
+    sdl_job Job;
+    bool32 Found = SDLPopJob(&Worker->Deque, &Job);
+    if (!Found && (JobSystem->WorkerCount > 1)) {
+        Worker->RandomState ^= Worker->RandomState << 13;
+        Worker->RandomState ^= Worker->RandomState >> 17;
+        Worker->RandomState ^= Worker->RandomState << 5;
+
+        uint32 FirstVictim = Worker->RandomState % JobSystem->WorkerCount;
+        for (uint32 Offset = 0; !Found && (Offset < JobSystem->WorkerCount); ++Offset) {
+            uint32 VictimIndex = (FirstVictim + Offset) % JobSystem->WorkerCount;
+            if (VictimIndex != Worker->WorkerIndex) {
+                Found = SDLStealJob(&JobSystem->Workers[VictimIndex].Deque, &Job);
+            }
+        }
+    }
+
+    if (Found) {
+        SDLExecuteJob(Worker, &Job);
+    }
+
+    return (Found);
+}
+
+internal void*
+SDLWorkerThreadProc(void* Parameter) {
+    sdl_worker* Worker = (sdl_worker*) Parameter;
+    platform_job_system* JobSystem = Worker->JobSystem;
+    GlobalWorkerIndex = Worker->WorkerIndex;
+
+    while (!__atomic_load_n(&JobSystem->Quit, __ATOMIC_ACQUIRE)) {
+        bool32 RanJob = false;
+        for (int SpinIndex = 0; !RanJob && (SpinIndex < 256); ++SpinIndex) {
+            RanJob = SDLRunNextJob(Worker);
+            if (!RanJob) {
+                _mm_pause();
+            }
+        }
+
+        if (!RanJob) {
+            // NOTE: announce the sleep before the final look so an AddJob
+            // racing with us either sees SleepingCount or leaves a job to find
+            __atomic_add_fetch(&JobSystem->SleepingCount, 1, __ATOMIC_SEQ_CST);
+            if (!SDLRunNextJob(Worker) && !__atomic_load_n(&JobSystem->Quit, __ATOMIC_ACQUIRE)) {
+                sem_wait(&JobSystem->WakeSemaphore);
+            }
+            __atomic_sub_fetch(&JobSystem->SleepingCount, 1, __ATOMIC_SEQ_CST);
+        }
+    }
+
+    return (0);
+}
+
+internal
+PLATFORM_ADD_JOB(SDLAddJob) {
+    sdl_worker* Worker = &JobSystem->Workers[GlobalWorkerIndex];
+
+    sdl_job Job;
+    Job.Callback = Callback;
+    Job.Data = Data;
+    Job.Group = Group;
+
+    __atomic_add_fetch(&Group->PendingCount, 1, __ATOMIC_RELAXED);
+    if (SDLPushJob(&Worker->Deque, Job)) {
+        // NOTE: the other half of the sleep handshake; without it the load
+        // below can pass the Bottom store, and a worker going to sleep and
+        // this push can each miss the other
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&JobSystem->SleepingCount, __ATOMIC_SEQ_CST) > 0) {
+            sem_post(&JobSystem->WakeSemaphore);
+        }
+    } else {
+        // NOTE: deque is full; doing the job now is the cheapest back-pressure
+        SDLExecuteJob(Worker, &Job);
+    }
+}
+
+internal
+PLATFORM_WAIT_FOR_JOB_GROUP(SDLWaitForJobGroup) {
+    sdl_worker* Worker = &JobSystem->Workers[GlobalWorkerIndex];
+    while (__atomic_load_n(&Group->PendingCount, __ATOMIC_ACQUIRE) != 0) {
+        if (!SDLRunNextJob(Worker)) {
+            _mm_pause();
+        }
+    }
+}
+
+internal
+PLATFORM_GET_SCRATCH_ARENA(SDLGetScratchArena) {
+    memory_arena* Result = &JobSystem->Workers[GlobalWorkerIndex].Scratch;
+    return (Result);
+}
+
+/*
+ * WorkerCount includes the calling thread, so WorkerCount - 1 pthreads are
+ * started. Each worker gets ScratchSize bytes of scratch arena.
+ */
+internal bool32
+SDLInitJobSystem(platform_job_system* JobSystem, uint32 WorkerCount, memory_index ScratchSize) {
+    bool32 Result = false;
+
+    *JobSystem = {};
+    if (WorkerCount < 1) {
+        WorkerCount = 1;
+    }
+
+    memory_index WorkersSize = WorkerCount * sizeof(sdl_worker);
+    memory_index TotalSize = WorkersSize + WorkerCount * ScratchSize;
+    void* Memory = mmap(0, TotalSize, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (Memory != MAP_FAILED) {
+        JobSystem->Workers = (sdl_worker*) Memory;
+        JobSystem->MappedSize = TotalSize;
+        JobSystem->WorkerCount = WorkerCount;
+        sem_init(&JobSystem->WakeSemaphore, 0, 0);
+
+        uint8* ScratchBase = (uint8*) Memory + WorkersSize;
+        for (uint32 WorkerIndex = 0; WorkerIndex < WorkerCount; ++WorkerIndex) {
+            sdl_worker* Worker = &JobSystem->Workers[WorkerIndex];
+            Worker->JobSystem = JobSystem;
+            Worker->WorkerIndex = WorkerIndex;
+            Worker->RandomState = 0x9E3779B9u * (WorkerIndex + 1);
+            InitializeArena(&Worker->Scratch, ScratchSize, ScratchBase + WorkerIndex * ScratchSize);
+        }
+
+        Result = true;
+        for (uint32 WorkerIndex = 1; WorkerIndex < WorkerCount; ++WorkerIndex) {
+            sdl_worker* Worker = &JobSystem->Workers[WorkerIndex];
+            if (pthread_create(&Worker->Thread, 0, SDLWorkerThreadProc, Worker) != 0) {
+                // NOTE: run with the workers we managed to start
+                JobSystem->WorkerCount = WorkerIndex;
+                break;
+            }
+        }
+    }
+
+    return (Result);
+}
+
+internal void
+SDLShutdownJobSystem(platform_job_system* JobSystem) {
+    if (JobSystem->Workers) {
+        __atomic_store_n(&JobSystem->Quit, true, __ATOMIC_RELEASE);
+        for (uint32 WorkerIndex = 1; WorkerIndex < JobSystem->WorkerCount; ++WorkerIndex) {
+            sem_post(&JobSystem->WakeSemaphore);
+        }
+        for (uint32 WorkerIndex = 1; WorkerIndex < JobSystem->WorkerCount; ++WorkerIndex) {
+            pthread_join(JobSystem->Workers[WorkerIndex].Thread, 0);
+        }
+        sem_destroy(&JobSystem->WakeSemaphore);
+        munmap(JobSystem->Workers, JobSystem->MappedSize);
+        *JobSystem = {};
+    }
+}
+
+internal void
+SDLConnectJobSystem(game_memory* GameMemory, platform_job_system* JobSystem) {
+    GameMemory->JobSystem = JobSystem;
+    GameMemory->AddJob = SDLAddJob;
+    GameMemory->WaitForJobGroup = SDLWaitForJobGroup;
+    GameMemory->GetScratchArena = SDLGetScratchArena;
+}
+
+//
+// File hot reload
+//
+
+internal void
+SDLReloadWatchedFile(platform_file_watcher* FileWatcher, sdl_watched_file* Watched) {
+    debug_read_file_result File = DEBUGPlatformReadEntireFile(Watched->Path);
+    if (!File.Contents) {
+        __atomic_add_fetch(&FileWatcher->FailedReadCount, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    // NOTE: if the main thread hasn't taken the previous reload yet, this one
+    // supersedes it
+    void* Superseded = __atomic_exchange_n(&Watched->PendingContents, File.Contents, __ATOMIC_ACQ_REL);
+    DEBUGPlatformFreeFileMemory(Superseded);
+}
+
+internal void*
+SDLFileWatcherThreadProc(void* Parameter) {
+    platform_file_watcher* FileWatcher = (platform_file_watcher*) Parameter;
+
+    uint8 EventBuffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    struct pollfd Polls[2] = {};
+    Polls[0].fd = FileWatcher->NotifyFd;
+    Polls[0].events = POLLIN;
+    Polls[1].fd = FileWatcher->QuitFd;
+    Polls[1].events = POLLIN;
+
+    for (;;) {
+        if (poll(Polls, ArrayCount(Polls), -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (Polls[1].revents) {
+            break;
+        }
+
+        ssize_t Length = read(FileWatcher->NotifyFd, EventBuffer, sizeof(EventBuffer));
+        if (Length <= 0) {
+            continue;
+        }
+
+        uint32 FileCount = __atomic_load_n(&FileWatcher->FileCount, __ATOMIC_ACQUIRE);
+        for (uint8* At = EventBuffer; At < EventBuffer + Length;) {
+            struct inotify_event* Event = (struct inotify_event*) At;
+            At += sizeof(struct inotify_event) + Event->len;
+            if (Event->len == 0) {
+                continue;
+            }
+
+            for (uint32 FileIndex = 0; FileIndex < FileCount; ++FileIndex) {
+                sdl_watched_file* Watched = &FileWatcher->Files[FileIndex];
+                if ((Watched->WatchDescriptor == Event->wd) && (strcmp(Watched->Name, Event->name) == 0)) {
+                    SDLReloadWatchedFile(FileWatcher, Watched);
+                }
+            }
+        }
+    }
+
+    return (0);
+}
+
+/*
+ * Registers the file and reads it once right away. Must be called from the
+ * main thread. Watching the same path twice hands back the same file.
+ */
+internal
+PLATFORM_WATCH_FILE(SDLWatchFile) {
+    uint32 FileCount = FileWatcher->FileCount;
+    for (uint32 FileIndex = 0; FileIndex < FileCount; ++FileIndex) {
+        if (strcmp(FileWatcher->Files[FileIndex].Path, Filename) == 0) {
+            return (&FileWatcher->Files[FileIndex].File);
+        }
+    }
+
+    if ((FileCount == SDL_MAX_WATCHED_FILES) || (strlen(Filename) >= sizeof(FileWatcher->Files[0].Path))) {
+        return (0);
+    }
+
+    sdl_watched_file* Watched = &FileWatcher->Files[FileCount];
+    *Watched = {};
+    strcpy(Watched->Path, Filename);
+    Watched->WatchDescriptor = -1;
+
+    char Directory[sizeof(Watched->Path)] = ".";
+    char* Slash = strrchr(Watched->Path, '/');
+    if (Slash) {
+        memory_index DirectoryLength = Slash - Watched->Path;
+        if (DirectoryLength == 0) {
+            DirectoryLength = 1;
+        }
+        memcpy(Directory, Watched->Path, DirectoryLength);
+        Directory[DirectoryLength] = 0;
+        Watched->Name = Slash + 1;
+    } else {
+        Watched->Name = Watched->Path;
+    }
+
+    if (FileWatcher->Enabled) {
+        // NOTE: the same directory always comes back with the same descriptor
+        Watched->WatchDescriptor = inotify_add_watch(FileWatcher->NotifyFd, Directory,
+                                                     IN_CLOSE_WRITE | IN_MOVED_TO);
+    }
+
+    // NOTE: published before the first read, so a change that lands between
+    // the two is picked up as a reload instead of being lost
+    __atomic_store_n(&FileWatcher->FileCount, FileCount + 1, __ATOMIC_RELEASE);
+
+    debug_read_file_result File = DEBUGPlatformReadEntireFile(Watched->Path);
+    if (File.Contents) {
+        Watched->File.Contents = File.Contents;
+        Watched->File.ContentsSize = File.ContentsSize;
+        Watched->File.Version = 1;
+    }
+
+    return (&Watched->File);
+}
+
+/*
+ * Called by the main loop between frames. Never blocks: files whose reload
+ * hasn't finished yet are simply picked up on a later frame.
+ */
+internal void
+SDLSwapReloadedFiles(platform_file_watcher* FileWatcher) {
+    for (uint32 FileIndex = 0; FileIndex < FileWatcher->FileCount; ++FileIndex) {
+        sdl_watched_file* Watched = &FileWatcher->Files[FileIndex];
+        if (!__atomic_load_n(&Watched->PendingContents, __ATOMIC_RELAXED)) {
+            continue;
+        }
+
+        void* Contents = __atomic_exchange_n(&Watched->PendingContents, (void*) 0, __ATOMIC_ACQUIRE);
+        DEBUGPlatformFreeFileMemory(Watched->File.Contents);
+        Watched->File.Contents = Contents;
+        Watched->File.ContentsSize = SDLGetFileMemoryHeader(Contents)->ContentsSize;
+        ++Watched->File.Version;
+        ++FileWatcher->ReloadCount;
+    }
+}
+
+/*
+ * Without inotify the watcher still hands out files; they just never reload.
+ */
+internal void
+SDLInitFileWatcher(platform_file_watcher* FileWatcher) {
+    *FileWatcher = {};
+    FileWatcher->NotifyFd = inotify_init1(IN_CLOEXEC);
+    FileWatcher->QuitFd = eventfd(0, EFD_CLOEXEC);
+    if ((FileWatcher->NotifyFd != -1) && (FileWatcher->QuitFd != -1) &&
+        (pthread_create(&FileWatcher->Thread, 0, SDLFileWatcherThreadProc, FileWatcher) == 0)) {
+        FileWatcher->Enabled = true;
+    } else {
+        fprintf(stderr, "File watcher unavailable (%s); files won't reload\n", strerror(errno));
+    }
+}
+
+internal void
+SDLShutdownFileWatcher(platform_file_watcher* FileWatcher) {
+    if (FileWatcher->Enabled) {
+        uint64 Quit = 1;
+        write(FileWatcher->QuitFd, &Quit, sizeof(Quit));
+        pthread_join(FileWatcher->Thread, 0);
+    }
+    if (FileWatcher->NotifyFd != -1) {
+        close(FileWatcher->NotifyFd);
+    }
+    if (FileWatcher->QuitFd != -1) {
+        close(FileWatcher->QuitFd);
+    }
+
+    for (uint32 FileIndex = 0; FileIndex < FileWatcher->FileCount; ++FileIndex) {
+        sdl_watched_file* Watched = &FileWatcher->Files[FileIndex];
+        DEBUGPlatformFreeFileMemory(Watched->PendingContents);
+        DEBUGPlatformFreeFileMemory(Watched->File.Contents);
+    }
+    *FileWatcher = {};
+}
+
+internal void
+SDLConnectFileWatcher(game_memory* GameMemory, platform_file_watcher* FileWatcher) {
+    GameMemory->FileWatcher = FileWatcher;
+    GameMemory->WatchFile = SDLWatchFile;
+}
+
+//
+// Frame and audio capture
+//
+
+/*
+ * BT.601 full-range, integer only; the Y4M header says C444 so there's no
+ * chroma subsampling to do.
+ */
+internal void
+SDLCaptureConvertFrame(sdl_capture* Capture, uint8* Pixels) {
+    int PixelCount = Capture->Width * Capture->Height;
+    uint8* PlaneY = Capture->Planes;
+    uint8* PlaneU = PlaneY + PixelCount;
+    uint8* PlaneV = PlaneU + PixelCount;
+
+    uint32* Source = (uint32*) Pixels;
+    for (int PixelIndex = 0; PixelIndex < PixelCount; ++PixelIndex) {
+        uint32 Color = Source[PixelIndex];
+        int R = (Color >> 16) & 0xFF;
+        int G = (Color >> 8) & 0xFF;
+        int B = (Color >> 0) & 0xFF;
+        PlaneY[PixelIndex] = (uint8) ((77 * R + 150 * G + 29 * B) >> 8);
+        PlaneU[PixelIndex] = (uint8) (((-43 * R - 85 * G + 128 * B) >> 8) + 128);
+        PlaneV[PixelIndex] = (uint8) (((128 * R - 107 * G - 21 * B) >> 8) + 128);
+    }
+}
+
+internal void
+SDLCaptureWriteVideoFrame(sdl_capture* Capture) {
+    fputs("FRAME\n", Capture->VideoFile);
+    fwrite(Capture->Planes, 3, Capture->Width * Capture->Height, Capture->VideoFile);
+}
+
+internal void
+SDLCaptureWriteSamples(sdl_capture* Capture, int16* Samples, uint32 SampleCount) {
+    local_persist int16 Silence[2 * 1024];
+
+    while (SampleCount) {
+        uint32 BatchCount = SampleCount;
+        int16* Source = Samples;
+        if (!Samples) {
+            BatchCount = (BatchCount > 1024) ? 1024 : BatchCount;
+            Source = Silence;
+        }
+        fwrite(Source, 2 * sizeof(int16), BatchCount, Capture->AudioFile);
+        Capture->AudioDataSize += BatchCount * 2 * sizeof(int16);
+        SampleCount -= BatchCount;
+    }
+}
+
+internal void*
+SDLCaptureThreadProc(void* Parameter) {
+    sdl_capture* Capture = (sdl_capture*) Parameter;
+    bool32 HasFrame = false;
+
+    for (;;) {
+        sem_wait(&Capture->FilledSemaphore);
+
+        uint32 ReadIndex = Capture->ReadIndex;
+        while (ReadIndex != __atomic_load_n(&Capture->WriteIndex, __ATOMIC_ACQUIRE)) {
+            sdl_capture_slot* Slot = &Capture->Slots[ReadIndex % CAPTURE_SLOT_COUNT];
+
+            if (HasFrame) {
+                for (uint32 Repeat = 0; Repeat < Slot->DroppedFramesBefore; ++Repeat) {
+                    SDLCaptureWriteVideoFrame(Capture);
+                }
+            }
+            SDLCaptureWriteSamples(Capture, 0, Slot->DroppedSamplesBefore);
+
+            SDLCaptureConvertFrame(Capture, Slot->Pixels);
+            SDLCaptureWriteVideoFrame(Capture);
+            SDLCaptureWriteSamples(Capture, Slot->Samples, Slot->SampleCount);
+            HasFrame = true;
+
+            ++ReadIndex;
+            __atomic_store_n(&Capture->ReadIndex, ReadIndex, __ATOMIC_RELEASE);
+            __atomic_add_fetch(&Capture->FramesWritten, 1, __ATOMIC_RELAXED);
+        }
+
+        if (__atomic_load_n(&Capture->Quit, __ATOMIC_ACQUIRE) &&
+            (ReadIndex == __atomic_load_n(&Capture->WriteIndex, __ATOMIC_ACQUIRE))) {
+            break;
+        }
+    }
+
+    return (0);
+}
+
+internal void
+SDLCaptureWriteWaveHeader(sdl_capture* Capture) {
+    wave_header Header = {};
+    Header.RiffID = WAVE_ChunkID_RIFF;
+    Header.Size = (uint32) (4 + 2 * sizeof(wave_chunk) + sizeof(wave_fmt) + Capture->AudioDataSize);
+    Header.WaveID = WAVE_ChunkID_WAVE;
+
+    wave_chunk FormatChunk = {WAVE_ChunkID_fmt, sizeof(wave_fmt)};
+    wave_fmt Format = {};
+    Format.wFormatTag = 1;
+    Format.nChannels = 2;
+    Format.nSamplesPerSec = Capture->SamplesPerSecond;
+    Format.nAvgBytesPerSec = Capture->SamplesPerSecond * 2 * sizeof(int16);
+    Format.nBlockAlign = 2 * sizeof(int16);
+    Format.wBitsPerSample = 16;
+
+    wave_chunk DataChunk = {WAVE_ChunkID_data, (uint32) Capture->AudioDataSize};
+
+    fwrite(&Header, sizeof(Header), 1, Capture->AudioFile);
+    fwrite(&FormatChunk, sizeof(FormatChunk), 1, Capture->AudioFile);
+    fwrite(&Format, sizeof(Format), 1, Capture->AudioFile);
+    fwrite(&DataChunk, sizeof(DataChunk), 1, Capture->AudioFile);
+}
+
+/*
+ * Writes BaseName.y4m and BaseName.wav. Every buffer the capture needs is
+ * allocated here, so the per-frame cost is two copies and no allocation.
+ */
+internal bool32
+SDLInitCapture(sdl_capture* Capture, char const* BaseName, int Width, int Height, int FramesPerSecond,
+               int SamplesPerSecond) {
+    *Capture = {};
+    Capture->Width = Width;
+    Capture->Height = Height;
+    Capture->SamplesPerSecond = SamplesPerSecond;
+    Capture->MaxSampleCount = SamplesPerSecond;
+
+    char Filename[512];
+    snprintf(Filename, sizeof(Filename), "%s.y4m", BaseName);
+    Capture->VideoFile = fopen(Filename, "wb");
+    snprintf(Filename, sizeof(Filename), "%s.wav", BaseName);
+    Capture->AudioFile = fopen(Filename, "wb");
+    if (!Capture->VideoFile || !Capture->AudioFile) {
+        if (Capture->VideoFile) {
+            fclose(Capture->VideoFile);
+        }
+        if (Capture->AudioFile) {
+            fclose(Capture->AudioFile);
+        }
+        *Capture = {};
+        return false;
+    }
+
+    memory_index PixelsSize = (memory_index) Width * Height * 4;
+    memory_index SamplesSize = (memory_index) Capture->MaxSampleCount * 2 * sizeof(int16);
+    memory_index PlanesSize = (memory_index) Width * Height * 3;
+    Capture->MemorySize = CAPTURE_SLOT_COUNT * (PixelsSize + SamplesSize) + PlanesSize;
+    // NOTE: populated up front so the first lap of the ring doesn't fault on the main thread
+    Capture->Memory = mmap(0, Capture->MemorySize, PROT_READ | PROT_WRITE,
+                           MAP_ANONYMOUS | MAP_PRIVATE | MAP_POPULATE, -1, 0);
+    if (Capture->Memory == MAP_FAILED) {
+        fclose(Capture->VideoFile);
+        fclose(Capture->AudioFile);
+        *Capture = {};
+        return false;
+    }
+
+    uint8* At = (uint8*) Capture->Memory;
+    for (int SlotIndex = 0; SlotIndex < CAPTURE_SLOT_COUNT; ++SlotIndex) {
+        Capture->Slots[SlotIndex].Pixels = At;
+        At += PixelsSize;
+        Capture->Slots[SlotIndex].Samples = (int16*) At;
+        At += SamplesSize;
+    }
+    Capture->Planes = At;
+
+    fprintf(Capture->VideoFile, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", Width, Height, FramesPerSecond);
+    // NOTE: sizes are patched in by SDLCloseCapture
+    SDLCaptureWriteWaveHeader(Capture);
+
+    sem_init(&Capture->FilledSemaphore, 0, 0);
+    if (pthread_create(&Capture->Thread, 0, SDLCaptureThreadProc, Capture) != 0) {
+        // NOTE: no writer, so nothing would ever drain the ring
+        fclose(Capture->VideoFile);
+        fclose(Capture->AudioFile);
+        munmap(Capture->Memory, Capture->MemorySize);
+        sem_destroy(&Capture->FilledSemaphore);
+        *Capture = {};
+        return false;
+    }
+    Capture->Enabled = true;
+
+    return true;
+}
+
+/*
+ * Called once per frame by the main loop. Never waits on the writer: with
+ * no free slot (or a backbuffer that changed size) the frame is dropped.
+ */
+internal void
+SDLCaptureFrame(sdl_capture* Capture, sdl_offscreen_buffer* Backbuffer, game_sound_output_buffer* SoundBuffer) {
+    if (!Capture->Enabled) {
+        return;
+    }
+
+    uint32 SampleCount = SoundBuffer->SampleCount;
+    uint32 WriteIndex = Capture->WriteIndex;
+    uint32 ReadIndex = __atomic_load_n(&Capture->ReadIndex, __ATOMIC_ACQUIRE);
+    if (((WriteIndex - ReadIndex) >= CAPTURE_SLOT_COUNT) ||
+        (Backbuffer->Width != Capture->Width) || (Backbuffer->Height != Capture->Height)) {
+        ++Capture->PendingDroppedFrames;
+        Capture->PendingDroppedSamples += SampleCount;
+        ++Capture->FramesDropped;
+        return;
+    }
+
+    sdl_capture_slot* Slot = &Capture->Slots[WriteIndex % CAPTURE_SLOT_COUNT];
+    Slot->DroppedFramesBefore = Capture->PendingDroppedFrames;
+    Slot->DroppedSamplesBefore = Capture->PendingDroppedSamples;
+    Capture->PendingDroppedFrames = 0;
+    Capture->PendingDroppedSamples = 0;
+
+    SDLCopyBackbufferLinear(Backbuffer, Slot->Pixels, Capture->Width * 4);
+
+    if (SampleCount > Capture->MaxSampleCount) {
+        Slot->DroppedSamplesBefore += SampleCount - Capture->MaxSampleCount;
+        SampleCount = Capture->MaxSampleCount;
+    }
+    memcpy(Slot->Samples, SoundBuffer->Samples, SampleCount * 2 * sizeof(int16));
+    Slot->SampleCount = SampleCount;
+
+    __atomic_store_n(&Capture->WriteIndex, WriteIndex + 1, __ATOMIC_RELEASE);
+    sem_post(&Capture->FilledSemaphore);
+}
+
+internal void
+SDLCloseCapture(sdl_capture* Capture) {
+    if (!Capture->Enabled) {
+        return;
+    }
+
+    __atomic_store_n(&Capture->Quit, true, __ATOMIC_RELEASE);
+    sem_post(&Capture->FilledSemaphore);
+    pthread_join(Capture->Thread, 0);
+    sem_destroy(&Capture->FilledSemaphore);
+
+    // NOTE: trailing drops still count towards the session length
+    if (Capture->FramesWritten) {
+        for (uint32 Repeat = 0; Repeat < Capture->PendingDroppedFrames; ++Repeat) {
+            SDLCaptureWriteVideoFrame(Capture);
+        }
+    }
+    SDLCaptureWriteSamples(Capture, 0, Capture->PendingDroppedSamples);
+    fseek(Capture->AudioFile, 0, SEEK_SET);
+    SDLCaptureWriteWaveHeader(Capture);
+
+    fclose(Capture->VideoFile);
+    fclose(Capture->AudioFile);
+    munmap(Capture->Memory, Capture->MemorySize);
+
+    // NOTE: the counters stay valid for reporting
+    Capture->Enabled = false;
+    Capture->Memory = 0;
+}
+
+//
+// Startup
+//
+
+internal uint32
+SDLBeginStartupPhase(sdl_startup_timing* Timing, char const* Name, uint32 Flags) {
+    uint32 Result = Timing->PhaseCount;
+    if (Timing->PhaseCount < SDL_MAX_STARTUP_PHASES) {
+        sdl_startup_phase* Phase = &Timing->Phases[Timing->PhaseCount++];
+        Phase->Name = Name;
+        Phase->Flags = Flags;
+        Phase->Begin = SDL_GetPerformanceCounter();
+        Phase->End = Phase->Begin;
+    }
+    return (Result);
+}
+
+internal void
+SDLEndStartupPhase(sdl_startup_timing* Timing, uint32 PhaseIndex) {
+    if (PhaseIndex < Timing->PhaseCount) {
+        Timing->Phases[PhaseIndex].End = SDL_GetPerformanceCounter();
+    }
+}
+
+internal void*
+SDLStartupTaskThreadProc(void* Parameter) {
+    sdl_startup_task* Task = (sdl_startup_task*) Parameter;
+    Task->Phase.Begin = SDL_GetPerformanceCounter();
+    Task->Proc(Task->Data);
+    Task->Phase.End = SDL_GetPerformanceCounter();
+    __atomic_store_n(&Task->Done, true, __ATOMIC_RELEASE);
+    return (0);
+}
+
+internal void
+SDLStartStartupTask(sdl_startup_task* Task, char const* Name, sdl_startup_task_proc* Proc, void* Data) {
+    *Task = {};
+    Task->Phase.Name = Name;
+    Task->Phase.Flags = StartupPhase_Background;
+    Task->Proc = Proc;
+    Task->Data = Data;
+    if (pthread_create(&Task->Thread, 0, SDLStartupTaskThreadProc, Task) == 0) {
+        Task->Started = true;
+    } else {
+        Task->Phase.Flags = 0;
+        SDLStartupTaskThreadProc(Task);
+    }
+}
+
+// NOTE: a task that was never started counts as done
+inline bool32
+SDLIsStartupTaskDone(sdl_startup_task* Task) {
+    bool32 Result = (!Task->Proc || Task->Finished || __atomic_load_n(&Task->Done, __ATOMIC_ACQUIRE));
+    return (Result);
+}
+
+/*
+ * Waits for the task if it is still running, then records it. Tasks that
+ * were never started are left alone.
+ */
+internal void
+SDLFinishStartupTask(sdl_startup_timing* Timing, sdl_startup_task* Task) {
+    if (!Task->Proc || Task->Finished) {
+        return;
+    }
+    if (Task->Started) {
+        pthread_join(Task->Thread, 0);
+    }
+    if (Timing->PhaseCount < SDL_MAX_STARTUP_PHASES) {
+        Timing->Phases[Timing->PhaseCount++] = Task->Phase;
+    }
+    Task->Finished = true;
+}
+
+/*
+ * Faults in ranges that are already committed, without changing what is in
+ * them: the game may be writing to the same pages while this runs.
+ */
+internal
+SDL_STARTUP_TASK(SDLPrefaultTask) {
+    sdl_prefault* Prefault = (sdl_prefault*) Data;
+    long PageSize = sysconf(_SC_PAGESIZE);
+    for (uint32 RangeIndex = 0; RangeIndex < Prefault->RangeCount; ++RangeIndex) {
+        sdl_prefault_range* Range = &Prefault->Ranges[RangeIndex];
+        if (madvise(Range->Base, Range->Size, MADV_POPULATE_WRITE) != 0) {
+            Prefault->UsedFallback = true;
+            for (memory_index Offset = 0; Offset < Range->Size; Offset += PageSize) {
+                __atomic_fetch_add(Range->Base + Offset, 0, __ATOMIC_RELAXED);
+            }
+        }
+    }
+}
+
+internal void
+SDLPrintStartupTiming(sdl_startup_timing* Timing, FILE* Out) {
+    real64 MSPerCount = 1000.0 / (real64) SDL_GetPerformanceFrequency();
+    fprintf(Out, "Startup phases (ms from entering main):\n");
+    for (uint32 PhaseIndex = 0; PhaseIndex < Timing->PhaseCount; ++PhaseIndex) {
+        sdl_startup_phase* Phase = &Timing->Phases[PhaseIndex];
+        fprintf(Out, "  %-24s %8.02f  at %8.02f%s%s\n", Phase->Name,
+                (real64) (Phase->End - Phase->Begin) * MSPerCount,
+                (real64) (Phase->Begin - Timing->MainEntered) * MSPerCount,
+                (Phase->Flags & StartupPhase_Background) ? "  background" : "",
+                (Phase->Flags & StartupPhase_Deferred) ? "  after first frame" : "");
+    }
+    if (Timing->FirstFramePresented) {
+        fprintf(Out, "Time to first frame: %.02fms\n",
+                (real64) (Timing->FirstFramePresented - Timing->MainEntered) * MSPerCount);
+    }
+}
+
+#if !HANDMADE_BENCH
+// ENTER HERE
+int main(int argc, char* argv[]) {
+    GlobalStartupTiming.MainEntered = SDL_GetPerformanceCounter();
+
+    bool32 UsePerfCounters = false;
+    char* CaptureBaseName = 0;
+    int TileShift = 0;
+    // NOTE: presents inline by default; see SDLInitPresentQueue before asking for more
+    uint32 PresentBufferCount = 1;
+    for (int ArgIndex = 1; ArgIndex < argc; ++ArgIndex) {
+        if (strcmp(argv[ArgIndex], "--perf") == 0) {
+            UsePerfCounters = true;
+        } else if ((strcmp(argv[ArgIndex], "--capture") == 0) && (ArgIndex + 1 < argc)) {
+            CaptureBaseName = argv[++ArgIndex];
+        } else if ((strcmp(argv[ArgIndex], "--tiles") == 0) && (ArgIndex + 1 < argc)) {
+            int TileSize = atoi(argv[++ArgIndex]);
+            if (TileSize == 8) {
+                TileShift = 3;
+            } else if (TileSize == 16) {
+                TileShift = 4;
+            } else {
+                printf("Tile size must be 8 or 16; keeping a linear backbuffer\n");
+            }
+        } else if ((strcmp(argv[ArgIndex], "--present-buffers") == 0) && (ArgIndex + 1 < argc)) {
+            // NOTE: 2 or 3 present from their own thread
+            PresentBufferCount = (uint32) atoi(argv[++ArgIndex]);
+        }
+    }
+
+    // NOTE: only what the first frame can't do without runs up front. SDL
+    // subsystems are only brought up from this thread, so audio opens here
+    // too; the game's first pages fault in on their own thread, and
+    // controllers are opened after the first frame.
+    uint32 Phase = SDLBeginStartupPhase(&GlobalStartupTiming, "video init", 0);
+    SDL_Init(SDL_INIT_VIDEO);
+    SDLEndStartupPhase(&GlobalStartupTiming, Phase);
+    uint64 PerfCountFrequency = SDL_GetPerformanceFrequency();
+
+    sdl_sound_output SoundOutput = {};
+    SoundOutput.SamplesPerSecond = 48000;
+    SoundOutput.RunningSampleIndex = 0;
+    SoundOutput.BytesPerSample = sizeof(int16) * 2;
+    SoundOutput.SecondaryBufferSize = SoundOutput.SamplesPerSecond * SoundOutput.BytesPerSample;
+    SoundOutput.tSine = 0.0f;
+    SoundOutput.LatencySampleCount = SoundOutput.SamplesPerSecond / 15;
+
+    Phase = SDLBeginStartupPhase(&GlobalStartupTiming, "audio init and open", 0);
+    SDL_InitSubSystem(SDL_INIT_AUDIO);
+    SDLInitAudio(SoundOutput.SamplesPerSecond, SoundOutput.SecondaryBufferSize);
+    SDL_PauseAudio(0);
+    SDLEndStartupPhase(&GlobalStartupTiming, Phase);
+
+#if HANDMADE_INTERNAL
+    void* BaseAddress = (void*) Terabytes(2);
+#else
+    void *BaseAddress = (void *)(0);
+#endif
+
+    Phase = SDLBeginStartupPhase(&GlobalStartupTiming, "memory reserve", 0);
+    game_memory GameMemory = {};
+    GameMemory.PermanentStorageSize = Megabytes(64);
+    GameMemory.TransientStorageSize = Gigabytes(4);
+
+    // NOTE: only address space up front; the game commits what it touches
+    sdl_memory_region* PermanentRegion = SDLReserveMemoryRegion("permanent", BaseAddress,
+                                                                GameMemory.PermanentStorageSize);
+    void* TransientBaseAddress = BaseAddress ? (uint8*) BaseAddress + GameMemory.PermanentStorageSize : 0;
+    sdl_memory_region* TransientRegion = SDLReserveMemoryRegion("transient", TransientBaseAddress,
+                                                                GameMemory.TransientStorageSize);
+    Assert(PermanentRegion && TransientRegion);
+
+    GameMemory.PermanentStorage = PermanentRegion->Base;
+    GameMemory.TransientStorage = TransientRegion->Base;
+
+    // NOTE: the first frame commits 2.5MB permanent and 4.56MB transient
+    // (the region printout of an HH_FRAMES=1 run); rounded up to the next
+    // power of two, that is faulted in while the window comes up. With a
+    // single core that would only compete with the first frame, so it's skipped.
+    long CoreCount = sysconf(_SC_NPROCESSORS_ONLN);
+    sdl_prefault Prefault = {};
+    sdl_memory_region* PrefaultRegions[] = {PermanentRegion, TransientRegion};
+    memory_index PrefaultSizes[] = {Megabytes(4), Megabytes(8)};
+    for (int RegionIndex = 0; (CoreCount > 1) && (RegionIndex < ArrayCount(PrefaultRegions)); ++RegionIndex) {
+        sdl_memory_region* Region = PrefaultRegions[RegionIndex];
+        if (PlatformCommitMemory(Region->Base, PrefaultSizes[RegionIndex])) {
+            sdl_prefault_range* Range = &Prefault.Ranges[Prefault.RangeCount++];
+            Range->Base = Region->Base;
+            Range->Size = PrefaultSizes[RegionIndex];
+        }
+    }
+    SDLEndStartupPhase(&GlobalStartupTiming, Phase);
+    sdl_startup_task PrefaultTask = {};
+    if (Prefault.RangeCount) {
+        SDLStartStartupTask(&PrefaultTask, "memory prefault", SDLPrefaultTask, &Prefault);
+    }
+
+    if (UsePerfCounters) {
+        Phase = SDLBeginStartupPhase(&GlobalStartupTiming, "perf counters", 0);
+        SDLInitPerfCounters(&GlobalPerfCounters);
+        SDLEndStartupPhase(&GlobalStartupTiming, Phase);
+    }
+
+#if HANDMADE_INTERNAL
+    Phase = SDLBeginStartupPhase(&GlobalStartupTiming, "debug overlay", 0);
+    SDLInitDebugOverlay();
+    SDLEndStartupPhase(&GlobalStartupTiming, Phase);
+#endif
+
+    // create the window
+    Phase = SDLBeginStartupPhase(&GlobalStartupTiming, "window", 0);
+    SDL_Window* Window = SDL_CreateWindow("Handmade Hero",
+                                          SDL_WINDOWPOS_UNDEFINED,
+                                          SDL_WINDOWPOS_UNDEFINED,
+                                          640,
+                                          480,
+                                          SDL_WINDOW_RESIZABLE);
+    SDLEndStartupPhase(&GlobalStartupTiming, Phase);
+
+    if (Window) {
+        // NOTE: the renderer and backbuffers belong to the present queue
+        Phase = SDLBeginStartupPhase(&GlobalStartupTiming, "renderer and backbuffers", 0);
+        bool32 CanPresent = SDLInitPresentQueue(&GlobalPresentQueue, Window, 0, PresentBufferCount, TileShift);
+        SDLEndStartupPhase(&GlobalStartupTiming, Phase);
+
+        printf("Refresh rate is %d Hz\n", SDLGetWindowRefreshRate(Window));
+        int GameUpdateHz = 30;
         real32 TargetSecondsPerFrame = 1.0f / (real32) GameUpdateHz;
 
-        if (Renderer) {
+        if (CanPresent) {
             bool Running = true;
-            sdl_window_dimension Dimension = SDLGetWindowDimension(Window);
-            SDLResizeTexture(&GlobalBackbuffer, Renderer, Dimension.Width, Dimension.Height);
+            if (GlobalPresentQueue.Threaded) {
+                printf("Presenting from its own thread with %u backbuffers\n", GlobalPresentQueue.BufferCount);
+            }
 
             game_input Input[2] = {};
             game_input* NewInput = &Input[0];
             game_input* OldInput = &Input[1];
 
-            sdl_sound_output SoundOutput = {};
-            SoundOutput.SamplesPerSecond = 48000;
-            SoundOutput.RunningSampleIndex = 0;
-            SoundOutput.BytesPerSample = sizeof(int16) * 2;
-            SoundOutput.SecondaryBufferSize = SoundOutput.SamplesPerSecond * SoundOutput.BytesPerSample;
-            SoundOutput.tSine = 0.0f;
-            SoundOutput.LatencySampleCount = SoundOutput.SamplesPerSecond / 15;
-            // Open audio device
-            SDLInitAudio(48000, SoundOutput.SecondaryBufferSize);
             // NOTE: calloc() allocates memory and clears it to zero.
             // It accepts the number of things being allocated and their size.
             int16* Samples = (int16*) calloc(SoundOutput.SamplesPerSecond, SoundOutput.BytesPerSample);
-            SDL_PauseAudio(0);
 
-#if HANDMADE_INTERNAL
-            void* BaseAddress = (void*) Terabytes(2);
-#else
-            void *BaseAddress = (void *)(0);
-#endif
-
-            game_memory GameMemory = {};
-            GameMemory.PermanentStorageSize = Megabytes(64);
-            GameMemory.TransientStorageSize = Gigabytes(4);
+            if (CaptureBaseName) {
+                Phase = SDLBeginStartupPhase(&GlobalStartupTiming, "capture", 0);
+                if (!SDLInitCapture(&GlobalCapture, CaptureBaseName,
+                                    GlobalPresentQueue.Buffers[0].Width, GlobalPresentQueue.Buffers[0].Height,
+                                    GameUpdateHz, SoundOutput.SamplesPerSecond)) {
+                    printf("Couldn't start capture to %s\n", CaptureBaseName);
+                }
+                SDLEndStartupPhase(&GlobalStartupTiming, Phase);
+            }
 
-            uint64 TotalStorageSize = GameMemory.PermanentStorageSize + GameMemory.TransientStorageSize;
+            // NOTE: with enough headroom left over for GameUpdateHz frames in a
+            // row, the game gets to hand back memory it hasn't been using
+            int IdleFrameCount = 0;
 
-            GameMemory.PermanentStorage = mmap(BaseAddress, TotalStorageSize,
-                                               PROT_READ | PROT_WRITE,
-                                               MAP_ANON | MAP_PRIVATE,
-                                               -1, 0);
+            Phase = SDLBeginStartupPhase(&GlobalStartupTiming, "job system", 0);
+            if (SDLInitJobSystem(&GlobalJobSystem, (CoreCount > 0) ? (uint32) CoreCount : 1, Megabytes(4))) {
+                SDLConnectJobSystem(&GameMemory, &GlobalJobSystem);
+                printf("Job system running %u workers\n", GlobalJobSystem.WorkerCount);
+            }
+            SDLEndStartupPhase(&GlobalStartupTiming, Phase);
 
-            Assert(GameMemory.PermanentStorage);
+            Phase = SDLBeginStartupPhase(&GlobalStartupTiming, "file watcher", 0);
+            SDLInitFileWatcher(&GlobalFileWatcher);
+            SDLConnectFileWatcher(&GameMemory, &GlobalFileWatcher);
+            SDLEndStartupPhase(&GlobalStartupTiming, Phase);
 
-            GameMemory.TransientStorage = (uint8*) (GameMemory.PermanentStorage) + GameMemory.PermanentStorageSize;
+            // NOTE: set once the first frame is up and the deferred work is done
+            bool32 StartupComplete = false;
 
             int DebugTimeMarkerIndex = 0;
             sdl_debug_time_marker DebugTimeMarkers[GameUpdateHz / 2] = {0};
 
+            real64 MSPerFrame = 0.0;
+            real64 FPS = 0.0;
+            real64 MCPF = 0.0;
+
+            uint32 FirstFramePhase = SDLBeginStartupPhase(&GlobalStartupTiming, "first frame", 0);
+
             uint64 LastCounter = SDL_GetPerformanceCounter();
             uint64 LastCycleCount = _rdtsc();
             while (Running) {
@@ -652,20 +2442,42 @@ int main(int argc, char* argv[]) {
                 SoundBuffer.SampleCount = BytesToWrite / SoundOutput.BytesPerSample;
                 SoundBuffer.Samples = Samples;
 
-                game_offscreen_buffer Buffer = {};
-                Buffer.Memory = GlobalBackbuffer.Memory;
-                Buffer.Width = GlobalBackbuffer.Width;
-                Buffer.Height = GlobalBackbuffer.Height;
-                Buffer.Pitch = GlobalBackbuffer.Pitch;
+                NewInput->dtForFrame = TargetSecondsPerFrame;
+
+                // NOTE: the game is between frames, so nothing it saw last frame is in use
+                SDLSwapReloadedFiles(&GlobalFileWatcher);
+
+                sdl_offscreen_buffer* Backbuffer = SDLAcquireBackbuffer(&GlobalPresentQueue);
+                game_offscreen_buffer Buffer = SDLGetGameBuffer(Backbuffer);
+                SDLPerfBeginPhase(&GlobalPerfCounters);
                 GameUpdateAndRender(&GameMemory, NewInput, &Buffer, &SoundBuffer);
+                SDLPerfEndPhase(&GlobalPerfCounters, PerfPhase_GameUpdate);
+
+                SDLCaptureFrame(&GlobalCapture, Backbuffer, &SoundBuffer);
 
                 game_input* Temp = NewInput;
                 NewInput = OldInput;
                 OldInput = Temp;
 
+                SDLPerfBeginPhase(&GlobalPerfCounters);
                 SDLFillSoundBuffer(&SoundOutput, ByteToLock, BytesToWrite, &SoundBuffer);
+                SDLPerfEndPhase(&GlobalPerfCounters, PerfPhase_SoundFill);
+
+                // NOTE: not while startup work might still be touching the regions
+                GameMemory.TrimRequested = false;
+                if (StartupComplete &&
+                    (SDLGetSecondsElapsed(LastCounter, SDL_GetPerformanceCounter()) < 0.5f * TargetSecondsPerFrame)) {
+                    if (++IdleFrameCount >= GameUpdateHz) {
+                        GameMemory.TrimRequested = true;
+                        IdleFrameCount = 0;
+                    }
+                } else {
+                    IdleFrameCount = 0;
+                }
 
-                if (SDLGetSecondsElapsed(LastCounter, SDL_GetPerformanceCounter()) < TargetSecondsPerFrame) {
+                // NOTE: nothing to pace against yet, so the first frame goes up as soon as it's ready
+                if (GlobalStartupTiming.FirstFramePresented &&
+                    (SDLGetSecondsElapsed(LastCounter, SDL_GetPerformanceCounter()) < TargetSecondsPerFrame)) {
                     int32 TimeToSleep =
                             ((TargetSecondsPerFrame - SDLGetSecondsElapsed(LastCounter, SDL_GetPerformanceCounter())) *
                              1000) - 1;
@@ -681,11 +2493,37 @@ int main(int argc, char* argv[]) {
                 uint64 EndCounter = SDL_GetPerformanceCounter();
 
 #if HANDMADE_INTERNAL
-                SDLDebugSyncDisplay(&GlobalBackbuffer, ArrayCount(DebugTimeMarkers), DebugTimeMarkers,
+                SDLDebugSyncDisplay(Backbuffer, ArrayCount(DebugTimeMarkers), DebugTimeMarkers,
                                     &SoundOutput, TargetSecondsPerFrame);
+                // NOTE: shows the previous frame's timings; this one isn't over yet
+                SDLDebugDrawOverlay(Backbuffer, &SoundOutput, &GameMemory, MSPerFrame, FPS, MCPF);
 #endif
 
-                SDLUpdateWindow(Window, Renderer, &GlobalBackbuffer);
+                // NOTE: with a present thread this is only the handoff
+                SDLPerfBeginPhase(&GlobalPerfCounters);
+                SDLSubmitBackbuffer(&GlobalPresentQueue);
+                SDLPerfEndPhase(&GlobalPerfCounters, PerfPhase_Present);
+                SDLPerfEndFrame(&GlobalPerfCounters);
+
+                if (!StartupComplete) {
+                    if (!GlobalStartupTiming.FirstFramePresented) {
+                        // NOTE: nothing to overlap with yet, and this way it means on screen
+                        SDLFlushPresentQueue(&GlobalPresentQueue);
+                        GlobalStartupTiming.FirstFramePresented = GlobalPresentQueue.LastPresentedAt;
+                        SDLEndStartupPhase(&GlobalStartupTiming, FirstFramePhase);
+                    } else if (SDLIsStartupTaskDone(&PrefaultTask)) {
+                        SDLFinishStartupTask(&GlobalStartupTiming, &PrefaultTask);
+
+                        Phase = SDLBeginStartupPhase(&GlobalStartupTiming, "controllers and haptics",
+                                                     StartupPhase_Deferred);
+                        SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER | SDL_INIT_HAPTIC);
+                        SDLOpenGameControllers();
+                        SDLEndStartupPhase(&GlobalStartupTiming, Phase);
+
+                        SDLPrintStartupTiming(&GlobalStartupTiming, stdout);
+                        StartupComplete = true;
+                    }
+                }
 
 #if HANDMADE_INTERNAL
                 // this is debug code
@@ -704,11 +2542,9 @@ int main(int argc, char* argv[]) {
                 uint64 CounterElapsed = EndCounter - LastCounter;
                 uint64 CyclesElapsed = EndCycleCount - LastCycleCount;
 
-                real64 MSPerFrame = (((1000.0f * (real64) CounterElapsed) / (real64) PerfCountFrequency));
-                real64 FPS = (real64) PerfCountFrequency / (real64) CounterElapsed;
-                real64 MCPF = ((real64) CyclesElapsed / (1000.0f * 1000.0f));
-
-                printf("%.02fms/f, %.02ff/s, %.02fMHz/f\n", MSPerFrame, FPS, MCPF);
+                MSPerFrame = (((1000.0f * (real64) CounterElapsed) / (real64) PerfCountFrequency));
+                FPS = (real64) PerfCountFrequency / (real64) CounterElapsed;
+                MCPF = ((real64) CyclesElapsed / (1000.0f * 1000.0f));
 
                 LastCycleCount = EndCycleCount;
                 LastCounter = EndCounter;
@@ -720,7 +2556,27 @@ int main(int argc, char* argv[]) {
         // TODO: logging
     }
 
+    if (GlobalPerfCounters.Enabled) {
+        SDLDumpPerfCounters(&GlobalPerfCounters, "perf_counters.csv");
+        SDLClosePerfCounters(&GlobalPerfCounters);
+    }
+
+    if (GlobalCapture.Enabled) {
+        SDLCloseCapture(&GlobalCapture);
+        printf("Captured %llu frames, dropped %llu\n",
+               (unsigned long long) GlobalCapture.FramesWritten, (unsigned long long) GlobalCapture.FramesDropped);
+    }
+    SDLFlushPresentQueue(&GlobalPresentQueue);
+    SDLPrintPresentStats(&GlobalPresentQueue, stdout);
+    SDLShutdownPresentQueue(&GlobalPresentQueue);
+    SDLPrintMemoryRegions(stdout);
+    // NOTE: a quit before startup finished still has to wait for the prefault
+    SDLFinishStartupTask(&GlobalStartupTiming, &PrefaultTask);
+    GameShutdown(&GameMemory);
+    SDLShutdownFileWatcher(&GlobalFileWatcher);
+    SDLShutdownJobSystem(&GlobalJobSystem);
     SDLCloseGameControllers();
     SDL_Quit();
     return (0);
-}
\ No newline at end of file
+}
+#endif
@@ -8,6 +8,55 @@ struct sdl_offscreen_buffer {
     int Height;
     int Pitch;
     int BytesPerPixel;
+    // NOTE: same meaning as in game_offscreen_buffer; 0 is row-linear
+    int TileShift;
+    memory_index MemorySize;
+};
+
+#define SDL_MAX_PRESENT_BUFFERS 3
+#define SDL_PRESENT_LATENCY_HISTORY 256
+
+/*
+ * Hands finished frames from the main thread to the present thread, which
+ * owns the renderer and does the texture upload and SDL_RenderPresent. The
+ * main thread renders frame N+1 into the next buffer while frame N is being
+ * presented.
+ *
+ * SubmitCount and PresentCount only ever increase. The main thread renders
+ * into Buffers[SubmitCount % BufferCount] once FreeSemaphore says the present
+ * thread is done with it; the present thread takes frames in order off
+ * FilledSemaphore. Without a thread (Threaded false) there is one buffer and
+ * each submit presents inline, as before.
+ */
+struct sdl_present_queue {
+    bool32 Threaded;
+    uint32 BufferCount;
+    SDL_Window* Window;
+    // NOTE: a software renderer target instead of a window, for the bench
+    SDL_Surface* Surface;
+    SDL_Renderer* Renderer;
+    sdl_offscreen_buffer Buffers[SDL_MAX_PRESENT_BUFFERS];
+
+    pthread_t Thread;
+    sem_t ReadySemaphore;
+    sem_t FilledSemaphore;
+    sem_t FreeSemaphore;
+    volatile uint32 SubmitCount;
+    volatile uint32 PresentCount;
+    volatile bool32 Quit;
+
+    // NOTE: performance counter stamps; Latency is submit to presented. The
+    // totals are only written by whoever presents and are read with
+    // __atomic_load_n from anywhere else.
+    uint64 SubmittedAt[SDL_MAX_PRESENT_BUFFERS];
+    uint64 LastPresentedAt;
+    uint64 LatencyTotal;
+    uint64 LatencyMax;
+    uint64 PresentTotal;
+    // NOTE: by PresentCount; only safe to read after SDLFlushPresentQueue
+    uint64 Latencies[SDL_PRESENT_LATENCY_HISTORY];
+    // NOTE: main thread only; time spent waiting for a free buffer
+    uint64 FenceWaitTotal;
 };
 
 struct sdl_window_dimension {
@@ -37,6 +86,263 @@ struct sdl_debug_time_marker
     int WriteCursor;
 };
 
+enum sdl_perf_counter_type {
+    PerfCounter_Cycles,
+    PerfCounter_Instructions,
+    PerfCounter_CacheMisses,
+    PerfCounter_BranchMisses,
+    PerfCounter_PageFaults,
+
+    PerfCounter_Count,
+};
+
+enum sdl_perf_phase {
+    PerfPhase_GameUpdate,
+    PerfPhase_SoundFill,
+    PerfPhase_Present,
+
+    PerfPhase_Count,
+};
+
+struct sdl_perf_frame_record {
+    uint64 FrameIndex;
+    uint64 Values[PerfPhase_Count][PerfCounter_Count];
+};
+
+#define PERF_FRAME_RECORD_COUNT 1024
+
+struct sdl_perf_counters {
+    bool32 Enabled;
+
+    // NOTE: every counter that opened is in one group led by GroupFd, so a
+    // single read() returns all of them; ReadSlot is each counter's position
+    // in that read, or -1 if the kernel/hardware would not give it to us.
+    int GroupFd;
+    int Fds[PerfCounter_Count];
+    int ReadSlot[PerfCounter_Count];
+    int OpenCount;
+
+    uint64 PhaseStart[PerfCounter_Count];
+    sdl_perf_frame_record Current;
+
+    uint64 FrameIndex;
+    uint32 RecordCount;
+    uint32 NextRecord;
+    sdl_perf_frame_record Records[PERF_FRAME_RECORD_COUNT];
+};
+
+
+#define CAPTURE_SLOT_COUNT 16
+
+/*
+ * One queued frame. Frames dropped just before it are remembered so the
+ * writer can repeat the previous picture and pad with silence, keeping the
+ * video and audio files the same length as the session.
+ */
+struct sdl_capture_slot {
+    uint32 DroppedFramesBefore;
+    uint32 DroppedSamplesBefore;
+    uint32 SampleCount;
+    uint8* Pixels;
+    int16* Samples;
+};
+
+/*
+ * Single producer (the main loop), single consumer (the writer thread).
+ * WriteIndex and ReadIndex only ever increase; a slot is free while
+ * WriteIndex - ReadIndex < CAPTURE_SLOT_COUNT.
+ */
+struct sdl_capture {
+    bool32 Enabled;
+    int Width;
+    int Height;
+    int SamplesPerSecond;
+    uint32 MaxSampleCount;
+
+    FILE* VideoFile;
+    FILE* AudioFile;
+    uint64 AudioDataSize;
+    // NOTE: writer thread only; Y, U and V planes of the last frame written
+    uint8* Planes;
+
+    pthread_t Thread;
+    sem_t FilledSemaphore;
+    volatile uint32 WriteIndex;
+    volatile uint32 ReadIndex;
+    volatile bool32 Quit;
+
+    uint32 PendingDroppedFrames;
+    uint32 PendingDroppedSamples;
+    uint64 FramesDropped;
+    volatile uint64 FramesWritten;
+
+    void* Memory;
+    memory_index MemorySize;
+    sdl_capture_slot Slots[CAPTURE_SLOT_COUNT];
+};
+
+#define SDL_MAX_MEMORY_REGIONS 8
+#define SDL_COMMIT_GRANULARITY Kilobytes(64)
+
+/*
+ * A PROT_NONE reservation whose first CommittedSize bytes are read/write.
+ * ResidentSize is only as fresh as the last SDLUpdateMemoryRegionStats.
+ */
+struct sdl_memory_region {
+    char const* Name;
+    uint8* Base;
+    memory_index ReservedSize;
+
+    memory_index CommittedSize;
+    memory_index CommittedHighWater;
+    memory_index ResidentSize;
+    memory_index ResidentHighWater;
+
+    uint32 CommitCount;
+    uint32 DecommitCount;
+};
+
+struct sdl_job {
+    platform_job_callback* Callback;
+    void* Data;
+    platform_job_group* Group;
+};
+
+#define JOB_DEQUE_CAPACITY 4096
+
+/*
+ * Chase-Lev deque: the owning worker pushes and pops at Bottom, other
+ * workers steal from Top. Top and Bottom sit on separate cache lines.
+ */
+struct sdl_job_deque {
+    volatile int64 Top;
+    uint8 TopPad[56];
+    volatile int64 Bottom;
+    uint8 BottomPad[56];
+    sdl_job Jobs[JOB_DEQUE_CAPACITY];
+};
+
+struct sdl_worker {
+    platform_job_system* JobSystem;
+    uint32 WorkerIndex;
+    uint32 RandomState;
+    pthread_t Thread;
+    memory_arena Scratch;
+    sdl_job_deque Deque;
+};
+
+// NOTE: worker 0 is whichever thread called SDLInitJobSystem; it has a deque
+// and a scratch arena but no pthread of its own.
+struct platform_job_system {
+    uint32 WorkerCount;
+    sdl_worker* Workers;
+    memory_index MappedSize;
+
+    sem_t WakeSemaphore;
+    volatile uint32 SleepingCount;
+    volatile bool32 Quit;
+};
+
+/*
+ * Sits in front of every buffer DEBUGPlatformReadEntireFile hands out, so
+ * the buffer can be freed (and its size recovered) from the pointer alone.
+ */
+struct sdl_file_memory_header {
+    memory_index MappedSize;
+    uint32 ContentsSize;
+    uint32 Reserved;
+};
+
+#define SDL_MAX_WATCHED_FILES 64
+
+/*
+ * File is what the game sees and is only touched by the main thread. The
+ * watcher thread publishes freshly read contents through PendingContents;
+ * the main thread takes them at the next frame boundary.
+ */
+struct sdl_watched_file {
+    platform_watched_file File;
+
+    char Path[256];
+    char* Name;
+    int WatchDescriptor;
+
+    void* volatile PendingContents;
+};
+
+/*
+ * inotify watches each file's directory rather than the file itself, since
+ * most editors save by writing a new file and renaming it over the old one.
+ */
+struct platform_file_watcher {
+    bool32 Enabled;
+    int NotifyFd;
+    int QuitFd;
+    pthread_t Thread;
+
+    volatile uint32 FileCount;
+    sdl_watched_file Files[SDL_MAX_WATCHED_FILES];
+
+    uint32 ReloadCount;
+    volatile uint32 FailedReadCount;
+};
+
+enum sdl_startup_phase_flags {
+    StartupPhase_Background = 0x1, // NOTE: ran on its own thread
+    StartupPhase_Deferred = 0x2,   // NOTE: ran after the first frame
+};
+
+struct sdl_startup_phase {
+    char const* Name;
+    uint64 Begin;
+    uint64 End;
+    uint32 Flags;
+};
+
+#define SDL_MAX_STARTUP_PHASES 32
+
+/*
+ * Performance counter stamps, reported relative to MainEntered.
+ */
+struct sdl_startup_timing {
+    uint64 MainEntered;
+    uint64 FirstFramePresented;
+    uint32 PhaseCount;
+    sdl_startup_phase Phases[SDL_MAX_STARTUP_PHASES];
+};
+
+#define SDL_STARTUP_TASK(name) void name(void* Data)
+typedef SDL_STARTUP_TASK(sdl_startup_task_proc);
+
+/*
+ * Startup work that doesn't need the main thread. If the thread can't be
+ * started the work runs inline instead, so callers don't have to care.
+ */
+struct sdl_startup_task {
+    sdl_startup_phase Phase;
+    sdl_startup_task_proc* Proc;
+    void* Data;
+
+    pthread_t Thread;
+    bool32 Started;
+    volatile bool32 Done;
+    // NOTE: joined and recorded; only the main thread looks at this
+    bool32 Finished;
+};
+
+#define SDL_MAX_PREFAULT_RANGES 4
+
+struct sdl_prefault_range {
+    uint8* Base;
+    memory_index Size;
+};
+
+struct sdl_prefault {
+    uint32 RangeCount;
+    sdl_prefault_range Ranges[SDL_MAX_PREFAULT_RANGES];
+    // NOTE: the kernel predates MADV_POPULATE_WRITE, so pages were touched one by one
+    bool32 UsedFallback;
+};
 
 #define SDL_HANDMADE_H
 #endif
\ No newline at end of file